@@ -0,0 +1,58 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Host shim of the Arduino core: time base and Serial.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#include "Arduino.h"
+#include <stdarg.h>
+#include <time.h>
+
+HostSerial Serial;
+
+static uint64_t NowUs(){
+   struct timespec ts;
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+static const uint64_t gcStartUs = NowUs();
+
+uint32_t millis(){ return (uint32_t)( ( NowUs() - gcStartUs ) / 1000ull ); }
+
+uint32_t micros(){ return (uint32_t)( NowUs() - gcStartUs ); }
+
+void delay( uint32_t ms ){ delayMicroseconds( ms * 1000u ); }
+
+void delayMicroseconds( uint32_t us ){
+   struct timespec ts;
+   ts.tv_sec = us / 1000000u;
+   ts.tv_nsec = (long)( us % 1000000u ) * 1000l;
+   nanosleep( &ts, NULL );
+}
+
+size_t Print::printf_( const char* apFmt, ... ){
+   char vbuf[64];
+   va_list args;
+   va_start( args, apFmt );
+   int n = vsnprintf( vbuf, sizeof(vbuf), apFmt, args );
+   va_end( args );
+   if ( n < 0 ) return 0;
+   if ( n >= (int)sizeof(vbuf) ) n = sizeof(vbuf) - 1;
+   return write( vbuf, (size_t)n );
+}
@@ -0,0 +1,77 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Host shim of the Teensy Audio Library AudioStream base class.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#include <stddef.h>
+#include "AudioStream.h"
+
+audio_block_t* AudioStream::mpPool = NULL;
+unsigned int AudioStream::mPoolSize = 0;
+unsigned int AudioStream::memory_used = 0;
+
+AudioStream::AudioStream( unsigned char ninput, audio_block_t **iqueue ){
+   (void)ninput;
+   (void)iqueue;
+   for ( int i=0; i < AUDIO_MAX_OUTPUTS; ++i ) mOutput[i] = NULL;
+}
+
+AudioStream::~AudioStream(){
+   for ( int i=0; i < AUDIO_MAX_OUTPUTS; ++i ) release( mOutput[i] );
+}
+
+void AudioStream::initialize_memory( audio_block_t *data, unsigned int num ){
+   mpPool = data;
+   mPoolSize = num;
+   memory_used = 0;
+   for ( unsigned int i=0; i < num; ++i ) {
+      data[i].ref_count = 0;
+      data[i].memory_pool_index = (uint16_t)i;
+   }
+}
+
+audio_block_t* AudioStream::allocate(void){
+   for ( unsigned int i=0; i < mPoolSize; ++i ) {
+      if ( mpPool[i].ref_count == 0 ) {
+         mpPool[i].ref_count = 1;
+         ++memory_used;
+         return &mpPool[i];
+      }
+   }
+   return NULL;
+}
+
+void AudioStream::release( audio_block_t *block ){
+   if ( !block || block->ref_count == 0 ) return;
+   if ( --block->ref_count == 0 ) --memory_used;
+}
+
+void AudioStream::transmit( audio_block_t *block, unsigned char index ){
+   if ( index >= AUDIO_MAX_OUTPUTS ) return;
+   release( mOutput[index] );
+   mOutput[index] = block;
+   if ( block ) block->ref_count++;
+}
+
+audio_block_t* AudioStream::TakeOutput( unsigned int acIndex ){
+   if ( acIndex >= AUDIO_MAX_OUTPUTS ) return NULL;
+   audio_block_t* vblock = mOutput[acIndex];
+   mOutput[acIndex] = NULL;
+   return vblock;
+}
@@ -0,0 +1,515 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Kernel benchmarks: times each DSP building block on audio blocks and
+   prints one CSV line per kernel, so runs can be diffed or plotted.
+
+   usage: eris_bench [-b blocks] [-r rounds] [-z] [name_filter]
+
+   -b blocks per round (default 2000), -r rounds (default 5), the best
+   round is reported. Only the kernels whose name contains name_filter
+   are run. -z turns on flush-to-zero in hardware, like eris_render.
+
+   The *.tail kernels let the float state decay towards the denormals,
+   they should cost what the same kernel does on a signal.
+
+   Columns: kernel, samples per call, ns/sample, cycles/sample.
+   Cycles come from Profiler::Now(): the TSC on x86 (constant rate, not
+   core clocks), nanoseconds elsewhere.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <memory>
+#include "Arduino.h"
+#include "Eris.h"
+#include "Denormals.h"
+
+#define BENCH_SAMPLES AUDIO_BLOCK_SAMPLES
+#define BENCH_TAIL_BLOCKS 64 // one block of signal, then silence
+
+static const char* gFilter = NULL;
+static long gBlocks = 2000;
+static int gRounds = 5;
+static volatile float gSink; // keeps the scalar results alive
+
+// keeps the stores to a buffer alive once the kernel is inlined
+static inline void Escape( const void* ap ){ asm volatile( "" : : "g"( ap ) : "memory" ); }
+
+static double WallNs(){
+   struct timespec ts;
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// acRun( block ) processes acSamples samples, best round reported
+template <class F>
+static void Bench( const char* apName, int acSamples, F acRun ){
+   if ( gFilter && !strstr( apName, gFilter ) ) return;
+
+   for ( long b=0; b < gBlocks / 10 + 1; ++b ) acRun( b ); // warm up
+
+   double vbestns = 1e30;
+   double vbestcycles = 1e30;
+   for ( int r=0; r < gRounds; ++r ) {
+      const double t0 = WallNs();
+      const uint32_t c0 = Profiler::Now();
+      for ( long b=0; b < gBlocks; ++b ) acRun( b );
+      const uint32_t c1 = Profiler::Now();
+      const double t1 = WallNs();
+      if ( t1 - t0 < vbestns ) {
+         vbestns = t1 - t0;
+         vbestcycles = (double)(uint32_t)( c1 - c0 );
+      }
+   }
+   const double vsamples = (double)gBlocks * acSamples;
+   printf( "%s,%d,%.3f,%.2f\n", apName, acSamples, vbestns / vsamples, vbestcycles / vsamples );
+   fflush( stdout );
+}
+
+// test signals
+static int16_t gNoise16[BENCH_SAMPLES] __attribute__ ((aligned (4)));
+static float gNoiseF[BENCH_SAMPLES];
+static float gZeroF[BENCH_SAMPLES];
+static int16_t gSine16[BENCH_SAMPLES] __attribute__ ((aligned (4)));
+static float gSineF[BENCH_SAMPLES];
+static int16_t gSteps16[BENCH_SAMPLES] __attribute__ ((aligned (4))); // control rate Lfo
+
+static void InitSignals(){
+   uint32_t vseed = 1;
+   for ( int n=0; n < BENCH_SAMPLES; ++n ) {
+      vseed = vseed * 1664525u + 1013904223u;
+      gNoiseF[n] = ( (int32_t)( vseed >> 16 ) - 32768 ) * ( 0.25f / 32768.f );
+      gNoise16[n] = (int16_t)( gNoiseF[n] * 32767.f );
+      gSineF[n] = 0.8f * sinf( TWO_PI * n / BENCH_SAMPLES );
+      gSine16[n] = (int16_t)( gSineF[n] * 32767.f );
+      gSteps16[n] = gSine16[n & ~( LFO_DECIM - 1 )];
+   }
+}
+
+// the protected helpers of GenDyn
+class GenDynProbe : public GenDyn
+{
+public:
+   using GenDyn::mirroring;
+   using GenDyn::ComputeInterpDist;
+
+   // a flat segment long enough for the benchmark, the dc blocker
+   // decaying from acPrevOut
+   void StartFlat( float acPrevOut ){
+      mx = 0.f;
+      mC0 = 0.5f;
+      mC1 = 0.f;
+      mC2 = 0.f;
+      mPrevVal = 0.5f;
+      mPrevOut = acPrevOut;
+   }
+};
+
+static const char* const cDistNames[cNumDist] = { "linear", "exponential", "cauchy", "hyperbcos", "lfo" };
+
+// GenDyn::SetDist() value that selects dist acDist alone
+static float DistKnob( int acDist ){ return acDist * DIST_PARAM_RANGE; }
+
+// same knobs for every GenDyn case
+template <class Gen>
+static void SetupGen( Gen& aGen, int acDist, int acRange ){
+   aGen.Init( NULL, 1 );
+   aGen.SetFreqRange( acRange );
+   aGen.SetFreqNorm( 0.5f );
+   aGen.SetDist( DistKnob( acDist ) );
+   aGen.SetParam( 0.5f );
+   aGen.SetScale( 0.5f );
+}
+
+static void BenchGenDyn(){
+   char vname[96];
+   float vout[BENCH_SAMPLES];
+   int16_t vout16[BENCH_SAMPLES];
+
+   for ( int d=0; d < cNumDist; ++d ) {
+      for ( int vrange=0; vrange < 2; ++vrange ) {
+         const char* vrangename = vrange ? "lo" : "hi";
+         for ( int vfm=0; vfm < 2; ++vfm ) {
+            const float vfmamount = vfm ? 1.f : 0.f;
+
+            GenDyn vgen;
+            SetupGen( vgen, d, vrange );
+            snprintf( vname, sizeof(vname), "gendyn_float.%s.%s.%s", cDistNames[d], vrangename, vfm ? "fm" : "nofm" );
+            Bench( vname, BENCH_SAMPLES, [&]( long ){
+               vgen.Process( vout, gSineF, vfmamount, BENCH_SAMPLES );
+               Escape( vout );
+            } );
+
+            GenDynFixed vgenq;
+            SetupGen( vgenq, d, vrange );
+            snprintf( vname, sizeof(vname), "gendyn_fixed.%s.%s.%s", cDistNames[d], vrangename, vfm ? "fm" : "nofm" );
+            Bench( vname, BENCH_SAMPLES, [&]( long ){
+               vgenq.Process( vout16, gSine16, vfmamount, BENCH_SAMPLES );
+               Escape( vout16 );
+            } );
+         }
+      }
+
+      // control rate, LO range only and without FM
+      GenDyn vgen;
+      SetupGen( vgen, d, 1 );
+      snprintf( vname, sizeof(vname), "gendyn_float.%s.lo.ctlrate", cDistNames[d] );
+      Bench( vname, BENCH_SAMPLES, [&]( long ){
+         vgen.ProcessLfo( vout, BENCH_SAMPLES );
+         Escape( vout );
+      } );
+
+      GenDynFixed vgenq;
+      SetupGen( vgenq, d, 1 );
+      snprintf( vname, sizeof(vname), "gendyn_fixed.%s.lo.ctlrate", cDistNames[d] );
+      Bench( vname, BENCH_SAMPLES, [&]( long ){
+         vgenq.ProcessLfo( vout16, BENCH_SAMPLES );
+         Escape( vout16 );
+      } );
+   }
+
+   // stochastic durations, against the exponential.hi.* cases above
+   for ( int vfm=0; vfm < 2; ++vfm ) {
+      const float vfmamount = vfm ? 1.f : 0.f;
+
+      GenDyn vgen;
+      SetupGen( vgen, Exponential, 0 );
+      vgen.SetDurDist( 0.5f );
+      vgen.SetDurScale( 0.5f );
+      snprintf( vname, sizeof(vname), "gendyn_float.%s.hi.%s.dur", cDistNames[Exponential], vfm ? "fm" : "nofm" );
+      Bench( vname, BENCH_SAMPLES, [&]( long ){
+         vgen.Process( vout, gSineF, vfmamount, BENCH_SAMPLES );
+         Escape( vout );
+      } );
+
+      GenDynFixed vgenq;
+      SetupGen( vgenq, Exponential, 0 );
+      vgenq.SetDurDist( 0.5f );
+      vgenq.SetDurScale( 0.5f );
+      snprintf( vname, sizeof(vname), "gendyn_fixed.%s.hi.%s.dur", cDistNames[Exponential], vfm ? "fm" : "nofm" );
+      Bench( vname, BENCH_SAMPLES, [&]( long ){
+         vgenq.Process( vout16, gSine16, vfmamount, BENCH_SAMPLES );
+         Escape( vout16 );
+      } );
+   }
+
+   // oversampled, decimators included
+   for ( int vos=2; vos <= OVERSAMPLE_MAX; vos *= 2 ) {
+      GenDyn vgen;
+      SetupGen( vgen, Exponential, 0 );
+      vgen.SetOversample( vos );
+      snprintf( vname, sizeof(vname), "gendyn_float.%s.hi.nofm.os%d", cDistNames[Exponential], vos );
+      Bench( vname, BENCH_SAMPLES, [&]( long ){
+         vgen.Process( vout, NULL, 0.f, BENCH_SAMPLES );
+         Escape( vout );
+      } );
+
+      GenDynFixed vgenq;
+      SetupGen( vgenq, Exponential, 0 );
+      vgenq.SetOversample( vos );
+      snprintf( vname, sizeof(vname), "gendyn_fixed.%s.hi.nofm.os%d", cDistNames[Exponential], vos );
+      Bench( vname, BENCH_SAMPLES, [&]( long ){
+         vgenq.Process( vout16, NULL, 0.f, BENCH_SAMPLES );
+         Escape( vout16 );
+      } );
+   }
+}
+
+static void BenchDist(){
+   char vname[96];
+   float vrand[BENCH_SAMPLES];
+   for ( int n=0; n < BENCH_SAMPLES; ++n ) vrand[n] = ( n + 0.5f ) / BENCH_SAMPLES;
+
+   for ( int d=0; d < cNumDist; ++d ) {
+      const DistConsts vconsts = DistTable::Prepare( (DistId)d, 0.5f );
+      snprintf( vname, sizeof(vname), "dist_eval.%s", cDistNames[d] );
+      Bench( vname, BENCH_SAMPLES, [&]( long ){
+         float vsum = 0.f;
+         for ( int n=0; n < BENCH_SAMPLES; ++n ) vsum += DistTable::Eval( vconsts, vrand[n], gSineF[n] );
+         gSink = vsum;
+      } );
+
+      DistTable vtable;
+      vtable.Build( (DistId)d, 0.5f );
+      snprintf( vname, sizeof(vname), "dist_lookup.%s", cDistNames[d] );
+      Bench( vname, BENCH_SAMPLES, [&]( long ){
+         float vsum = 0.f;
+         for ( int n=0; n < BENCH_SAMPLES; ++n ) vsum += vtable.Lookup( vrand[n], gSineF[n] );
+         gSink = vsum;
+      } );
+
+      // this dist crossfaded with the next one, as between the knob sectors
+      if ( d < cNumDist - 1 ) {
+         GenDynProbe vprobe;
+         vprobe.SetDist( DistKnob( d ) + 0.5f * DIST_PARAM_RANGE );
+         snprintf( vname, sizeof(vname), "dist_interp.%s", cDistNames[d] );
+         Bench( vname, BENCH_SAMPLES, [&]( long ){
+            float vsum = 0.f;
+            for ( int n=0; n < BENCH_SAMPLES; ++n ) vsum += vprobe.ComputeInterpDist( vrand[n], gSineF[n] );
+            gSink = vsum;
+         } );
+      }
+   }
+
+   GenDynProbe vprobe;
+   Bench( "mirroring", BENCH_SAMPLES, [&]( long ){
+      float vsum = 0.f;
+      for ( int n=0; n < BENCH_SAMPLES; ++n ) vsum += vprobe.mirroring( 4.f * gNoiseF[n] + gSineF[n], 0.6f );
+      gSink = vsum;
+   } );
+}
+
+static void BenchPipeline(){
+   int16_t vout16[BENCH_SAMPLES] __attribute__ ((aligned (4)));
+   float voutf[BENCH_SAMPLES];
+
+   Bench( "pipe_fixed.to_lfo", BENCH_SAMPLES, [&]( long ){
+      FixedPipeline::ToLfo( gNoise16, vout16, LFO_SCALE, BENCH_SAMPLES );
+      Escape( vout16 );
+   } );
+   Bench( "pipe_fixed.mix", BENCH_SAMPLES, [&]( long ){
+      memcpy( vout16, gNoise16, sizeof(vout16) );
+      FixedPipeline::Mix( vout16, gSine16, BENCH_SAMPLES );
+      Escape( vout16 );
+   } );
+   Bench( "pipe_float.to_lfo", BENCH_SAMPLES, [&]( long ){
+      FloatPipeline::ToLfo( gNoiseF, voutf, LFO_SCALE, BENCH_SAMPLES );
+      Escape( voutf );
+   } );
+   Bench( "pipe_float.to_unit", BENCH_SAMPLES, [&]( long ){
+      float vsum = 0.f;
+      for ( int n=0; n < BENCH_SAMPLES; ++n ) vsum += FixedPipeline::ToUnit( gNoise16[n] );
+      gSink = vsum;
+   } );
+   Bench( "pipe_float.to_int16", BENCH_SAMPLES, [&]( long ){
+      for ( int n=0; n < BENCH_SAMPLES; ++n ) vout16[n] = saturate16( (int32_t)( gNoiseF[n] * PIPE_Q15_SCALE ) );
+      Escape( vout16 );
+   } );
+}
+
+static void BenchFilters(){
+   char vname[96];
+   static const char* const cModeNames[cNumFilterModes] = { "lp", "bp", "hp", "notch", "peak", "morph" };
+   int16_t vout16[BENCH_SAMPLES];
+   float voutf[BENCH_SAMPLES];
+
+   struct CtlCase { const char* name; float octaves; const int16_t* ctl; const float* ctlf; int step; };
+   const CtlCase cCases[] = {
+      { "const",     0.f, gSine16,  gSineF, 1 },
+      { "modulated", 3.f, gSine16,  gSineF, 1 },
+      { "slow",      3.f, gSteps16, gSineF, LFO_DECIM },
+   };
+
+   for ( const CtlCase& c : cCases ) {
+      for ( int m=0; m < cNumFilterModes; ++m ) {
+         VCFixed vcf;
+         vcf.SetCutoff( 2000.f );
+         vcf.SetResonance( 2.f );
+         vcf.octaveControl( c.octaves );
+         vcf.SetMode( (FilterMode)m );
+         vcf.SetMorph( 0.3f );
+         snprintf( vname, sizeof(vname), "vcfixed.%s.%s", cModeNames[m], c.name );
+         Bench( vname, BENCH_SAMPLES, [&]( long ){
+            vcf.Process( gNoise16, vout16, c.ctl, BENCH_SAMPLES, c.step );
+            Escape( vout16 );
+         } );
+      }
+
+      VCFloat vcff;
+      vcff.SetCutoff( 2000.f );
+      vcff.SetResonance( 2.f );
+      vcff.octaveControl( c.octaves );
+      snprintf( vname, sizeof(vname), "vcfloat.lp.%s", c.name );
+      Bench( vname, BENCH_SAMPLES, [&]( long ){
+         vcff.Process( gNoiseF, voutf, c.ctlf, BENCH_SAMPLES, c.step );
+         Escape( voutf );
+      } );
+   }
+}
+
+static void BenchEnv(){
+   int16_t vdata[BENCH_SAMPLES] __attribute__ ((aligned (4)));
+
+   // each state is held for far longer than the benchmark runs
+   AREnv voff, vattack, vhold, vrelease;
+   voff.SetBiasGain( 0.5f );
+   for ( int b=0; b < 1000; ++b ) voff.Process( vdata, BENCH_SAMPLES ); // settle the bias
+
+   vattack.SetGain( 1.f );
+   vattack.SetAttackMs( 1e7f );
+   vattack.TriggerAttack();
+
+   vhold.SetGain( 1.f );
+   vhold.SetAttackMs( 0.f );
+   vhold.TriggerAttack();
+   vhold.Process( vdata, BENCH_SAMPLES );
+
+   vrelease.SetGain( 1.f );
+   vrelease.SetAttackMs( 0.f );
+   vrelease.SetReleaseMs( 1e7f );
+   vrelease.TriggerAttack();
+   vrelease.Process( vdata, BENCH_SAMPLES );
+   vrelease.TriggerRelease();
+
+   struct EnvCase { const char* name; AREnv* env; };
+   const EnvCase cCases[] = { { "arenv.off", &voff }, { "arenv.attack", &vattack },
+                              { "arenv.hold", &vhold }, { "arenv.release", &vrelease } };
+   for ( const EnvCase& c : cCases ) {
+      Bench( c.name, BENCH_SAMPLES, [&]( long ){
+         memcpy( vdata, gNoise16, sizeof(vdata) );
+         c.env->Process( vdata, BENCH_SAMPLES );
+         Escape( vdata );
+      } );
+   }
+}
+
+static void BenchTails(){
+   float vout[BENCH_SAMPLES];
+
+   // just above the denormals: a few thousand samples of 0.9999 decay
+   // take it below
+   for ( int vtail=0; vtail < 2; ++vtail ) {
+      GenDynProbe vgen;
+      vgen.Init( NULL, 1 );
+      vgen.SetFreqRange( 1 );
+      vgen.SetFreqNorm( 0.f );
+      Bench( vtail ? "gendyn_float.tail" : "gendyn_float.flat", BENCH_SAMPLES, [&]( long b ){
+         if ( b % BENCH_TAIL_BLOCKS == 0 ) vgen.StartFlat( vtail ? 2e-38f : 0.25f );
+         vgen.Process( vout, NULL, 0.f, BENCH_SAMPLES );
+         Escape( vout );
+      } );
+   }
+
+   VCFloat vcff;
+   vcff.SetCutoff( 2000.f );
+   vcff.SetResonance( 2.f );
+   Bench( "vcfloat.lp.tail", BENCH_SAMPLES, [&]( long b ){
+      vcff.Process( b % BENCH_TAIL_BLOCKS == 0 ? gNoiseF : gZeroF, vout, NULL, BENCH_SAMPLES );
+      Escape( vout );
+   } );
+}
+
+static void BenchGains(){
+   int16_t vdata[BENCH_SAMPLES] __attribute__ ((aligned (4)));
+   int16_t vout[BENCH_SAMPLES] __attribute__ ((aligned (4)));
+   float vdataf[BENCH_SAMPLES];
+
+   // the copies are part of every case, see "copy" for their cost
+   Bench( "gain.copy", BENCH_SAMPLES, [&]( long ){
+      memcpy( vdata, gNoise16, sizeof(vdata) );
+      Escape( vdata );
+   } );
+   Bench( "gain.mulc", BENCH_SAMPLES, [&]( long ){
+      memcpy( vdata, gNoise16, sizeof(vdata) );
+      MulC( vdata, 40000, BENCH_SAMPLES );
+      Escape( vdata );
+   } );
+   Bench( "gain.mulc_copy", BENCH_SAMPLES, [&]( long ){
+      MulC( vout, gNoise16, 40000, BENCH_SAMPLES );
+      Escape( vout );
+   } );
+   Bench( "gain.mulramp", BENCH_SAMPLES, [&]( long ){
+      memcpy( vdata, gNoise16, sizeof(vdata) );
+      MulRamp( vdata, 20000, 10, BENCH_SAMPLES );
+      Escape( vdata );
+   } );
+   // the target flips every 64 blocks, longer than a full ramp takes
+   ParamSmoother vsmooth;
+   vsmooth.SetLinear( GAIN_RAMP_STEP );
+   Bench( "gain.smoother_int16", BENCH_SAMPLES, [&]( long b ){
+      vsmooth.SetTarget( ( b & 64 ) ? 60000 : 0 );
+      memcpy( vdata, gNoise16, sizeof(vdata) );
+      vsmooth.Apply( vdata, BENCH_SAMPLES );
+      Escape( vdata );
+   } );
+   Bench( "gain.smoother_float", BENCH_SAMPLES, [&]( long b ){
+      vsmooth.SetTarget( ( b & 64 ) ? 60000 : 0 );
+      memcpy( vdataf, gNoiseF, sizeof(vdataf) );
+      vsmooth.Apply( vdataf, BENCH_SAMPLES );
+      Escape( vdataf );
+   } );
+}
+
+// a whole update(), one voice holding a note
+template <class Synth>
+static void BenchUpdate( const char* apName, bool acLfo ){
+   if ( gFilter && !strstr( apName, gFilter ) ) return;
+
+   std::unique_ptr<Synth> vmodule( new Synth );
+   Synth& module = *vmodule;
+   float vpSeeds[NUM_CONTROL_PTS_MAX] = {};
+   module.Init( vpSeeds );
+   module.Seed( 1 );
+   module.SetGen1Gain( 0.5f );
+   module.SetGen2Gain( 0.5f );
+   module.SetGen1Dist( 0.6f );
+   module.SetGen2Dist( 0.3f );
+   module.SetGen2Range( acLfo );
+   module.SetRateMod( acLfo );
+   module.SetCutoffMod( acLfo );
+   module.SetGen2ToOut( !acLfo );
+   module.SetReleaseMs( 1e7f ); // the warm up and the rounds may outlast the note
+   module.TriggerMidiNoteAt( 45, 100, 0 );
+
+   Bench( apName, AUDIO_BLOCK_SAMPLES, [&]( long ){
+      module.update();
+      audio_block_t* vleft = module.TakeOutput( 0 );
+      audio_block_t* vright = module.TakeOutput( 1 );
+      if ( vleft ) gSink = vleft->data[0];
+      AudioStream::release( vleft );
+      AudioStream::release( vright );
+   } );
+}
+
+static void Usage(){
+   fprintf( stderr, "usage: eris_bench [-b blocks] [-r rounds] [-z] [name_filter]\n" );
+}
+
+int main( int argc, char** argv ){
+   bool vflush = false;
+   for ( int i=1; i < argc; ++i ) {
+      const char* a = argv[i];
+      bool vhasval = i + 1 < argc;
+      if ( !strcmp(a,"-b") && vhasval ) gBlocks = atol( argv[++i] );
+      else if ( !strcmp(a,"-r") && vhasval ) gRounds = atoi( argv[++i] );
+      else if ( !strcmp(a,"-z") ) vflush = true;
+      else if ( a[0] != '-' && !gFilter ) gFilter = a;
+      else { Usage(); return 1; }
+   }
+   if ( gBlocks < 1 || gRounds < 1 ) { Usage(); return 1; }
+
+   AudioMemory(NUM_MEMORY_BLOCKS);
+   InitSignals();
+   std::unique_ptr<DenormalGuard> vguard( vflush ? new DenormalGuard : NULL );
+
+   printf( "kernel,samples,ns_per_sample,cycles_per_sample\n" );
+   BenchGenDyn();
+   BenchDist();
+   BenchPipeline();
+   BenchFilters();
+   BenchEnv();
+   BenchTails();
+   BenchGains();
+   BenchUpdate< ErisSynth<FixedPipeline> >( "update.fixed", false );
+   BenchUpdate< ErisSynth<FixedPipeline> >( "update.fixed.lfo", true );
+   BenchUpdate< ErisSynth<FloatPipeline> >( "update.float", false );
+   return 0;
+}
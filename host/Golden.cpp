@@ -0,0 +1,614 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Golden output regression test: plays scripted knob, switch and MIDI
+   scenarios through both pipelines with fixed seeds and checks the
+   output and every module tap against stored hashes.
+
+   usage: eris_golden [-g golden.txt] [-u] [-w dir] [-c dir] [-e snr_db]
+                      [-q] [name_filter]
+
+   -g reference hashes (default host/golden.txt)
+   -u rewrites the hashes of the scenarios run instead of checking them
+   -w dumps every stream to dir as raw float32, for -c later
+   -c compares against a -w dump instead of the hashes, failing streams
+      below -e dB SNR (default: any difference fails)
+   -q only prints the failures
+
+   Streams are the transmitted block and the gen2, gen1, vcf and env taps
+   of every voice (see Taps.h), named like v0.gen1. Each scenario also
+   reports how far the float pipeline is from the fixed one, per stage.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+#include "Eris.h"
+
+#ifndef ERIS_TAPS
+#error "eris_golden needs the taps, build it against a library compiled with ERIS_TAPS"
+#endif
+
+#define GOLDEN_NOTE_OFFSET 37 // notes land mid-block, so the event split is covered
+#define GOLDEN_VELOCITY 100
+#define GOLDEN_NUM_STREAMS ( 1 + ERIS_MAX_VOICES * cNumTapPoints )
+
+//-------------------------------------------------------------------
+// Scenarios
+
+enum ScriptOp
+{
+   Op_Note=0,     // mono note on, value = note
+   Op_Release,    // mono release
+   Op_PolyOn,     // value = note
+   Op_PolyOff,
+   Op_Voices,
+   Op_Steal,
+   Op_Gen1Rate,
+   Op_Gen1Dist,
+   Op_Gen1Param,
+   Op_Gen1Scale,
+   Op_Gen1Gain,
+   Op_Gen2Rate,
+   Op_Gen2Dist,
+   Op_Gen2Param,
+   Op_Gen2Scale,
+   Op_Gen2Gain,
+   Op_Gen2ToOut,
+   Op_Gen2Range,
+   Op_Sync,
+   Op_RateMod,
+   Op_CutMod,
+   Op_Cutoff,
+   Op_Resonance,
+   Op_FilterMode,
+   Op_Morph,
+   Op_Attack,
+   Op_ReleaseMs,
+   Op_Bias,
+   Op_Gen1DurDist,
+   Op_Gen1DurScale,
+   Op_Gen2DurDist,
+   Op_Gen2DurScale,
+   Op_Oversample,
+   Op_NoteAhead,    // mono note on 'to' blocks ahead, value = note
+   Op_ReleaseAhead, // mono release 'to' blocks ahead
+   Op_CutoffFlood   // 'to' cutoff changes in one block, ending at value
+};
+
+// value is applied at the start of block, then, if blocks > 0, the knob
+// is turned to 'to' over that many blocks (one new value per block).
+// The *Ahead and *Flood ops use 'to' as a count instead.
+struct ScriptStep
+{
+   int block;
+   ScriptOp op;
+   float value;
+   float to;
+   int blocks;
+};
+
+#define STEP_END { -1, Op_Note, 0.f, 0.f, 0 }
+
+struct Scenario
+{
+   const char* name;
+   uint32_t seed;
+   int blocks;
+   const ScriptStep* steps;
+};
+
+// the panel every scenario starts from is InitPanel() below: Gen2 in the
+// HI range mixed to the output, no modulation, one voice
+
+static const ScriptStep cDistLinear[] = {
+   { 0, Op_Gen1Dist, 0.f, 0.f, 0 }, { 0, Op_Gen2Dist, 0.f, 0.f, 0 }, { 0, Op_Note, 45, 0.f, 0 }, { 200, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+static const ScriptStep cDistExponential[] = {
+   { 0, Op_Gen1Dist, 0.25f, 0.f, 0 }, { 0, Op_Gen2Dist, 0.25f, 0.f, 0 }, { 0, Op_Note, 45, 0.f, 0 }, { 200, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+static const ScriptStep cDistCauchy[] = {
+   { 0, Op_Gen1Dist, 0.5f, 0.f, 0 }, { 0, Op_Gen2Dist, 0.5f, 0.f, 0 }, { 0, Op_Gen1Param, 0.8f, 0.f, 0 }, { 0, Op_Note, 45, 0.f, 0 },
+   { 200, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+static const ScriptStep cDistHyperbcos[] = {
+   { 0, Op_Gen1Dist, 0.75f, 0.f, 0 }, { 0, Op_Gen2Dist, 0.75f, 0.f, 0 }, { 0, Op_Gen1Param, 0.2f, 0.f, 0 }, { 0, Op_Note, 45, 0.f, 0 },
+   { 200, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+static const ScriptStep cDistLfo[] = {
+   { 0, Op_Gen1Dist, 1.f, 0.f, 0 }, { 0, Op_Gen2Dist, 1.f, 0.f, 0 }, { 0, Op_Note, 45, 0.f, 0 }, { 200, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+// crossfades between the distributions, params moving
+static const ScriptStep cDistSweep[] = {
+   { 0, Op_Note, 50, 0.f, 0 },
+   { 0, Op_Gen1Dist, 0.f, 1.f, 240 }, { 0, Op_Gen2Dist, 1.f, 0.f, 240 },
+   { 0, Op_Gen1Param, 0.1f, 0.9f, 120 }, { 120, Op_Gen2Param, 0.9f, 0.1f, 120 },
+   { 240, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+// Gen2 as an LFO on the Gen1 rate and the cutoff
+static const ScriptStep cLfoMod[] = {
+   { 0, Op_Gen2Range, 1, 0.f, 0 }, { 0, Op_Gen2ToOut, 0, 0.f, 0 }, { 0, Op_RateMod, 1, 0.f, 0 }, { 0, Op_CutMod, 1, 0.f, 0 },
+   { 0, Op_Cutoff, 2000.f, 0.f, 0 }, { 0, Op_Note, 45, 0.f, 0 },
+   { 60, Op_Gen2Rate, 0.1f, 0.9f, 120 }, { 220, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+// Gen2 at audio rate: FM of Gen1 and the cutoff
+static const ScriptStep cAudioMod[] = {
+   { 0, Op_RateMod, 1, 0.f, 0 }, { 0, Op_CutMod, 1, 0.f, 0 }, { 0, Op_Cutoff, 3000.f, 0.f, 0 }, { 0, Op_Note, 57, 0.f, 0 },
+   { 100, Op_Gen2ToOut, 0, 0.f, 0 }, { 200, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+// the range switch flipped while playing
+static const ScriptStep cRangeSwitch[] = {
+   { 0, Op_RateMod, 1, 0.f, 0 }, { 0, Op_Note, 45, 0.f, 0 }, { 80, Op_Gen2Range, 1, 0.f, 0 }, { 160, Op_Gen2Range, 0, 0.f, 0 },
+   { 220, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+static const ScriptStep cSync[] = {
+   { 0, Op_Sync, 1, 0.f, 0 }, { 0, Op_Note, 45, 0.f, 0 }, { 60, Op_Gen1Rate, 0.1f, 0.6f, 100 }, { 180, Op_Sync, 0, 0.f, 0 },
+   { 220, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+static const ScriptStep cKnobs[] = {
+   { 0, Op_Note, 40, 0.f, 0 },
+   { 0, Op_Cutoff, 200.f, 9000.f, 200 }, { 0, Op_Resonance, 0.7f, 4.5f, 200 },
+   { 20, Op_Gen1Scale, 0.f, 1.f, 80 }, { 40, Op_Gen1Gain, 0.5f, 0.05f, 60 },
+   { 100, Op_Gen2Scale, 1.f, 0.1f, 60 }, { 120, Op_Gen2Gain, 0.5f, 1.f, 40 },
+   { 200, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+static const ScriptStep cFilterModes[] = {
+   { 0, Op_Note, 45, 0.f, 0 }, { 0, Op_Cutoff, 1500.f, 0.f, 0 }, { 0, Op_Resonance, 3.f, 0.f, 0 },
+   { 40, Op_FilterMode, FilterMode_BandPass, 0.f, 0 }, { 80, Op_FilterMode, FilterMode_HighPass, 0.f, 0 },
+   { 120, Op_FilterMode, FilterMode_Notch, 0.f, 0 }, { 160, Op_FilterMode, FilterMode_Peak, 0.f, 0 },
+   { 200, Op_FilterMode, FilterMode_Morph, 0.f, 0 }, { 200, Op_Morph, 0.f, 1.f, 60 },
+   { 260, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+// a drone from the bias alone, then a note on top and the silent tail
+static const ScriptStep cBias[] = {
+   { 0, Op_Bias, 0.3f, 0.f, 0 }, { 60, Op_Note, 52, 0.f, 0 }, { 120, Op_Release, 0, 0.f, 0 }, { 140, Op_Bias, 0.f, 0.f, 0 },
+   { 200, Op_Note, 47, 0.f, 0 }, { 230, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+// short envelopes, retriggers, and the idle path in between
+static const ScriptStep cRetrigger[] = {
+   { 0, Op_Attack, 5.f, 0.f, 0 }, { 0, Op_ReleaseMs, 30.f, 0.f, 0 },
+   { 0, Op_Note, 45, 0.f, 0 }, { 30, Op_Release, 0, 0.f, 0 }, { 80, Op_Note, 48, 0.f, 0 }, { 90, Op_Note, 52, 0.f, 0 },
+   { 120, Op_Release, 0, 0.f, 0 }, { 200, Op_Note, 40, 0.f, 0 }, { 230, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+// a chord, then more notes than voices
+static const ScriptStep cPoly[] = {
+   { 0, Op_Voices, 4, 0.f, 0 }, { 0, Op_RateMod, 1, 0.f, 0 }, { 0, Op_ReleaseMs, 100.f, 0.f, 0 },
+   { 0, Op_PolyOn, 45, 0.f, 0 }, { 0, Op_PolyOn, 52, 0.f, 0 }, { 10, Op_PolyOn, 57, 0.f, 0 }, { 20, Op_PolyOn, 61, 0.f, 0 },
+   { 100, Op_PolyOff, 52, 0.f, 0 }, { 120, Op_PolyOn, 64, 0.f, 0 }, { 130, Op_PolyOn, 69, 0.f, 0 },
+   { 160, Op_Steal, VoiceSteal_Quietest, 0.f, 0 }, { 170, Op_PolyOn, 33, 0.f, 0 },
+   { 200, Op_PolyOff, 45, 0.f, 0 }, { 200, Op_PolyOff, 57, 0.f, 0 }, { 200, Op_PolyOff, 61, 0.f, 0 }, { 200, Op_PolyOff, 64, 0.f, 0 },
+   { 200, Op_PolyOff, 69, 0.f, 0 }, { 200, Op_PolyOff, 33, 0.f, 0 }, STEP_END
+};
+// high rates oversampled 2x then 4x, FM included, then Gen2 to the LO range (not oversampled) and back
+static const ScriptStep cOversample[] = {
+   { 0, Op_Oversample, 2, 0.f, 0 }, { 0, Op_Gen1Rate, 0.9f, 0.f, 0 }, { 0, Op_Gen2Rate, 0.8f, 0.f, 0 }, { 0, Op_Note, 81, 0.f, 0 },
+   { 80, Op_Oversample, 4, 0.f, 0 }, { 120, Op_RateMod, 1, 0.f, 0 }, { 160, Op_Gen2Range, 1, 0.f, 0 }, { 190, Op_Gen2Range, 0, 0.f, 0 },
+   { 220, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+// notes scheduled blocks ahead, out of order, with knobs and a note turned in the meantime
+static const ScriptStep cScheduled[] = {
+   { 0, Op_NoteAhead, 45, 40, 0 }, { 0, Op_ReleaseAhead, 0, 150, 0 },
+   { 5, Op_NoteAhead, 52, 15, 0 }, { 10, Op_Cutoff, 2000.f, 0.f, 0 }, { 30, Op_Gen1Rate, 0.1f, 0.6f, 60 },
+   { 160, Op_Note, 48, 0.f, 0 }, { 160, Op_Cutoff, 5000.f, 0.f, 0 }, { 220, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+// more param changes than the event queue holds: the last ones go through
+// FlushParams() on the next block
+static const ScriptStep cQueueFull[] = {
+   { 0, Op_Note, 45, 0.f, 0 }, { 20, Op_CutoffFlood, 600.f, 300.f, 0 }, { 100, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+// stochastic durations on both gens, Gen2 also in the LO range, then back off
+static const ScriptStep cDurations[] = {
+   { 0, Op_RateMod, 1, 0.f, 0 }, { 0, Op_Gen1DurDist, 0.3f, 0.f, 0 }, { 0, Op_Gen2DurDist, 0.6f, 0.f, 0 },
+   { 0, Op_Note, 45, 0.f, 0 }, { 20, Op_Gen1DurScale, 0.f, 1.f, 120 }, { 20, Op_Gen2DurScale, 0.5f, 0.f, 0 },
+   { 140, Op_Gen2Range, 1, 0.f, 0 }, { 200, Op_Gen1DurScale, 0.f, 0.f, 0 }, { 200, Op_Gen2DurScale, 0.f, 0.f, 0 },
+   { 240, Op_Release, 0, 0.f, 0 }, STEP_END
+};
+
+static const Scenario cScenarios[] = {
+   { "dist_linear",      101, 260, cDistLinear },
+   { "dist_exponential", 102, 260, cDistExponential },
+   { "dist_cauchy",      103, 260, cDistCauchy },
+   { "dist_hyperbcos",   104, 260, cDistHyperbcos },
+   { "dist_lfo",         105, 260, cDistLfo },
+   { "dist_sweep",       106, 300, cDistSweep },
+   { "lfo_mod",          107, 280, cLfoMod },
+   { "audio_mod",        108, 260, cAudioMod },
+   { "range_switch",     109, 280, cRangeSwitch },
+   { "sync",             110, 280, cSync },
+   { "knobs",            111, 260, cKnobs },
+   { "filter_modes",     112, 320, cFilterModes },
+   { "bias",             113, 300, cBias },
+   { "retrigger",        114, 280, cRetrigger },
+   { "poly",             115, 280, cPoly },
+   { "durations",        116, 280, cDurations },
+   { "oversample",       117, 280, cOversample },
+   { "scheduled",        118, 260, cScheduled },
+   { "queue_full",       119, 140, cQueueFull },
+};
+static const int cNumScenarios = sizeof(cScenarios) / sizeof(cScenarios[0]);
+
+//-------------------------------------------------------------------
+// Capture
+
+// stream 0 is the output, then cNumTapPoints per voice
+struct Capture
+{
+   std::vector<float> streams[GOLDEN_NUM_STREAMS];
+};
+
+static void TapToCapture( void* apUser, TapPoint acPoint, int acVoice, const float* apData, int acSamples ){
+   std::vector<float>& vstream = ((Capture*)apUser)->streams[1 + acVoice * cNumTapPoints + acPoint];
+   vstream.insert( vstream.end(), apData, apData + acSamples );
+}
+
+static std::string StreamName( int acStream ){
+   if ( acStream == 0 ) return "out";
+   const int vtap = acStream - 1;
+   char vname[32];
+   snprintf( vname, sizeof(vname), "v%d.%s", vtap / cNumTapPoints, Taps::PointName( (TapPoint)( vtap % cNumTapPoints ) ) );
+   return vname;
+}
+
+// same panel state as setup() in Main.cpp
+template <class Synth>
+static void InitPanel( Synth& aModule, uint32_t acSeed ){
+   float vpSeeds[NUM_CONTROL_PTS_MAX] = {};
+   aModule.Init(vpSeeds);
+   aModule.Seed(acSeed);
+
+   aModule.SetGen1Rate(0.15f);
+   aModule.SetGen1Dist(1);
+   aModule.SetGen1Gain( 0.5f );
+   aModule.SetGen1Scale(0.3f);
+   aModule.SetGen1Param(0.4f);
+   aModule.SetGen2Rate(0.1f);
+   aModule.SetGen2Dist(1);
+   aModule.SetGen2Gain( 0.5f );
+   aModule.SetGen2Scale(0.6f);
+   aModule.SetGen2Param(0.4f);
+   aModule.SetCutoff(8000.f);
+   aModule.SetResonance(1.f);
+   aModule.SetVCABiasGain(0.f);
+   aModule.SetRateMod(false);
+   aModule.SetCutoffMod(false);
+   aModule.SetGen2ToOut(true);
+   aModule.SetGen2Range(false);
+   aModule.SyncGens(0);
+}
+
+template <class Synth>
+static void ApplyStep( Synth& aModule, ScriptOp acOp, float acValue, uint32_t acTime, int acAhead = 0 ){
+   const byte vnote = (byte)acValue;
+   switch ( acOp ) {
+      case Op_Note:       aModule.TriggerMidiNoteAt( vnote, GOLDEN_VELOCITY, acTime ); break;
+      case Op_Release:    aModule.TriggerReleaseAt( acTime ); break;
+      case Op_PolyOn:     aModule.NoteOnAt( vnote, GOLDEN_VELOCITY, acTime ); break;
+      case Op_PolyOff:    aModule.NoteOffAt( vnote, acTime ); break;
+      case Op_Voices:     aModule.SetNumVoices( (int)acValue ); break;
+      case Op_Steal:      aModule.SetVoiceSteal( (VoiceSteal)(int)acValue ); break;
+      case Op_Gen1Rate:   aModule.SetGen1Rate( acValue ); break;
+      case Op_Gen1Dist:   aModule.SetGen1Dist( acValue ); break;
+      case Op_Gen1Param:  aModule.SetGen1Param( acValue ); break;
+      case Op_Gen1Scale:  aModule.SetGen1Scale( acValue ); break;
+      case Op_Gen1Gain:   aModule.SetGen1Gain( acValue ); break;
+      case Op_Gen2Rate:   aModule.SetGen2Rate( acValue ); break;
+      case Op_Gen2Dist:   aModule.SetGen2Dist( acValue ); break;
+      case Op_Gen2Param:  aModule.SetGen2Param( acValue ); break;
+      case Op_Gen2Scale:  aModule.SetGen2Scale( acValue ); break;
+      case Op_Gen2Gain:   aModule.SetGen2Gain( acValue ); break;
+      case Op_Gen2ToOut:  aModule.SetGen2ToOut( acValue != 0.f ); break;
+      case Op_Gen2Range:  aModule.SetGen2Range( acValue != 0.f ); break;
+      case Op_Sync:       aModule.SyncGens( acValue != 0.f ); break;
+      case Op_RateMod:    aModule.SetRateMod( acValue != 0.f ); break;
+      case Op_CutMod:     aModule.SetCutoffMod( acValue != 0.f ); break;
+      case Op_Cutoff:     aModule.SetCutoff( acValue ); break;
+      case Op_Resonance:  aModule.SetResonance( acValue ); break;
+      case Op_FilterMode: aModule.SetFilterMode( (FilterMode)(int)acValue ); break;
+      case Op_Morph:      aModule.SetFilterMorph( acValue ); break;
+      case Op_Attack:     aModule.SetAttackMs( acValue ); break;
+      case Op_ReleaseMs:  aModule.SetReleaseMs( acValue ); break;
+      case Op_Bias:       aModule.SetVCABiasGain( acValue ); break;
+      case Op_Gen1DurDist:  aModule.SetGen1DurDist( acValue ); break;
+      case Op_Gen1DurScale: aModule.SetGen1DurScale( acValue ); break;
+      case Op_Gen2DurDist:  aModule.SetGen2DurDist( acValue ); break;
+      case Op_Gen2DurScale: aModule.SetGen2DurScale( acValue ); break;
+      case Op_Oversample:   aModule.SetOversample( (int)acValue ); break;
+      case Op_NoteAhead:    aModule.TriggerMidiNoteAt( vnote, GOLDEN_VELOCITY, acTime + (uint32_t)acAhead * AUDIO_BLOCK_SAMPLES ); break;
+      case Op_ReleaseAhead: aModule.TriggerReleaseAt( acTime + (uint32_t)acAhead * AUDIO_BLOCK_SAMPLES ); break;
+      case Op_CutoffFlood:
+         for ( int i = acAhead - 1; i >= 0; --i ) aModule.SetCutoff( acValue + 10.f * i );
+         break;
+   }
+}
+
+template <class Synth>
+static void Run( const Scenario& acScen, Capture& aCapture ){
+   std::unique_ptr<Synth> vmodule( new Synth );
+   Synth& module = *vmodule;
+   InitPanel( module, acScen.seed );
+   Taps::SetHook( TapToCapture, &aCapture );
+
+   for ( int b=0; b < acScen.blocks; ++b ) {
+      const uint32_t vnotetime = (uint32_t)b * AUDIO_BLOCK_SAMPLES + GOLDEN_NOTE_OFFSET;
+      module.FlushParams(); // as ReadKnobs() does
+      for ( const ScriptStep* s = acScen.steps; s->block >= 0; ++s ) {
+         if ( b == s->block ) {
+            ApplyStep( module, s->op, s->value, vnotetime, (int)s->to );
+         }
+         else if ( s->blocks > 0 && b > s->block && b <= s->block + s->blocks ) {
+            const float vpos = (float)( b - s->block ) / s->blocks;
+            ApplyStep( module, s->op, s->value + ( s->to - s->value ) * vpos, vnotetime );
+         }
+      }
+
+      module.update();
+
+      // both channels carry the same block
+      audio_block_t* vleft = module.TakeOutput(0);
+      audio_block_t* vright = module.TakeOutput(1);
+      std::vector<float>& vout = aCapture.streams[0];
+      for ( int n=0; n < AUDIO_BLOCK_SAMPLES; ++n ) vout.push_back( vleft ? vleft->data[n] * (1.f/32767.f) : 0.f );
+      AudioStream::release( vleft );
+      AudioStream::release( vright );
+   }
+   Taps::SetHook( NULL, NULL );
+}
+
+//-------------------------------------------------------------------
+// Checks
+
+// FNV-1a over the sample bits
+static uint64_t Hash( const std::vector<float>& acData ){
+   uint64_t vhash = 14695981039346656037ull;
+   const uint8_t* vbytes = (const uint8_t*)acData.data();
+   for ( size_t i=0; i < acData.size() * sizeof(float); ++i ) {
+      vhash ^= vbytes[i];
+      vhash *= 1099511628211ull;
+   }
+   return vhash;
+}
+
+// SNR of acTest against acRef and the largest difference, over the common length
+struct Diff
+{
+   double signal{0.0};
+   double error{0.0};
+   float maxerr{0.f};
+
+   void Add( const std::vector<float>& acRef, const std::vector<float>& acTest ){
+      const size_t vn = acRef.size() < acTest.size() ? acRef.size() : acTest.size();
+      for ( size_t i=0; i < vn; ++i ) {
+         const double ve = (double)acTest[i] - acRef[i];
+         signal += (double)acRef[i] * acRef[i];
+         error += ve * ve;
+         if ( fabs( ve ) > maxerr ) maxerr = (float)fabs( ve );
+      }
+   }
+   double Snr() const {
+      if ( error == 0.0 ) return INFINITY;
+      if ( signal == 0.0 ) return -INFINITY;
+      return 10.0 * log10( signal / error );
+   }
+};
+
+typedef std::map<std::string, uint64_t> HashMap;
+
+static bool LoadHashes( const char* apPath, HashMap& aHashes ){
+   FILE* vfile = fopen( apPath, "r" );
+   if ( !vfile ) return false;
+   char vline[256];
+   while ( fgets( vline, sizeof(vline), vfile ) ) {
+      char vkey[200];
+      unsigned long long vhash;
+      if ( vline[0] == '#' ) continue;
+      if ( sscanf( vline, "%199s %llx", vkey, &vhash ) == 2 ) aHashes[vkey] = vhash;
+   }
+   fclose( vfile );
+   return true;
+}
+
+static bool SaveHashes( const char* apPath, const HashMap& acHashes ){
+   FILE* vfile = fopen( apPath, "w" );
+   if ( !vfile ) return false;
+   fprintf( vfile, "# eris_golden reference hashes: scenario.pipeline.stream fnv1a64\n" );
+   fprintf( vfile, "# regenerate with eris_golden -u after an intended change of the output\n" );
+   fprintf( vfile, "# bit-exact floats: eris_golden and its core build with -ffp-contract=off -fno-fast-math\n" );
+   for ( HashMap::const_iterator it = acHashes.begin(); it != acHashes.end(); ++it ) {
+      fprintf( vfile, "%s %016llx\n", it->first.c_str(), (unsigned long long)it->second );
+   }
+   const bool vok = ferror( vfile ) == 0;
+   fclose( vfile );
+   return vok;
+}
+
+static std::string DumpPath( const char* apDir, const std::string& acKey ){
+   return std::string( apDir ) + "/" + acKey + ".f32";
+}
+
+static bool WriteDump( const std::string& acPath, const std::vector<float>& acData ){
+   FILE* vfile = fopen( acPath.c_str(), "wb" );
+   if ( !vfile ) return false;
+   const bool vok = fwrite( acData.data(), sizeof(float), acData.size(), vfile ) == acData.size();
+   fclose( vfile );
+   return vok;
+}
+
+static bool ReadDump( const std::string& acPath, std::vector<float>& aData ){
+   FILE* vfile = fopen( acPath.c_str(), "rb" );
+   if ( !vfile ) return false;
+   float vbuf[1024];
+   size_t vn;
+   while ( ( vn = fread( vbuf, sizeof(float), 1024, vfile ) ) > 0 ) aData.insert( aData.end(), vbuf, vbuf + vn );
+   fclose( vfile );
+   return true;
+}
+
+struct GoldenOptions
+{
+   const char* golden{"host/golden.txt"};
+   const char* dumpdir{NULL};
+   const char* comparedir{NULL};
+   const char* filter{NULL};
+   double minsnr{INFINITY};
+   bool update{false};
+   bool quiet{false};
+};
+
+static void PrintSnr( double acSnr ){
+   if ( isinf( acSnr ) && acSnr > 0 ) printf( "   exact" );
+   else printf( " %7.1f", acSnr );
+}
+
+static const char* const cPipeNames[2] = { "fixed", "float" };
+
+// checks one pipeline of one scenario, returns the number of failed streams
+static int Check( const GoldenOptions& o, const std::string& acPrefix, const Capture& acCapture, HashMap& aHashes ){
+   int vfailed = 0;
+   for ( int s=0; s < GOLDEN_NUM_STREAMS; ++s ) {
+      const std::vector<float>& vdata = acCapture.streams[s];
+      if ( vdata.empty() ) continue;
+      const std::string vkey = acPrefix + "." + StreamName( s );
+
+      if ( o.dumpdir && !WriteDump( DumpPath( o.dumpdir, vkey ), vdata ) ) {
+         fprintf( stderr, "eris_golden: cannot write %s\n", DumpPath( o.dumpdir, vkey ).c_str() );
+         vfailed++;
+      }
+
+      if ( o.comparedir ) {
+         std::vector<float> vref;
+         if ( !ReadDump( DumpPath( o.comparedir, vkey ), vref ) ) {
+            printf( "FAIL %s: no reference in %s\n", vkey.c_str(), o.comparedir );
+            vfailed++;
+            continue;
+         }
+         Diff vdiff;
+         vdiff.Add( vref, vdata );
+         const bool vok = vref.size() == vdata.size() && vdiff.Snr() >= o.minsnr;
+         if ( !vok || !o.quiet ) {
+            printf( "%s %-34s snr", vok ? "  ok" : "FAIL", vkey.c_str() );
+            PrintSnr( vdiff.Snr() );
+            printf( " dB  max %.3g", vdiff.maxerr );
+            if ( vref.size() != vdata.size() ) printf( "  length %zu, reference %zu", vdata.size(), vref.size() );
+            printf( "\n" );
+         }
+         if ( !vok ) vfailed++;
+      }
+      else if ( o.update ) {
+         aHashes[vkey] = Hash( vdata );
+      }
+      else {
+         HashMap::const_iterator it = aHashes.find( vkey );
+         if ( it == aHashes.end() ) {
+            printf( "FAIL %s: no reference hash\n", vkey.c_str() );
+            vfailed++;
+         }
+         else if ( it->second != Hash( vdata ) ) {
+            printf( "FAIL %s: output changed\n", vkey.c_str() );
+            vfailed++;
+         }
+      }
+   }
+   return vfailed;
+}
+
+// float against fixed per stage, the voices pooled
+static void Report( const char* apName, const Capture& acFixed, const Capture& acFloat ){
+   Diff vdiffs[1 + cNumTapPoints];
+   for ( int s=0; s < GOLDEN_NUM_STREAMS; ++s ) {
+      const int vcol = s == 0 ? cNumTapPoints : ( s - 1 ) % cNumTapPoints;
+      vdiffs[vcol].Add( acFixed.streams[s], acFloat.streams[s] );
+   }
+   printf( "%-17s", apName );
+   for ( int c=0; c <= cNumTapPoints; ++c ) {
+      PrintSnr( vdiffs[c].Snr() );
+      printf( " %6.4f", vdiffs[c].maxerr );
+   }
+   printf( "\n" );
+}
+
+static void Usage(){
+   fprintf( stderr, "usage: eris_golden [-g golden.txt] [-u] [-w dir] [-c dir] [-e snr_db] [-q] [name_filter]\n" );
+}
+
+int main( int argc, char** argv ){
+   GoldenOptions o;
+
+   for ( int i=1; i < argc; ++i ) {
+      const char* a = argv[i];
+      bool vhasval = i + 1 < argc;
+      if ( !strcmp(a,"-g") && vhasval ) o.golden = argv[++i];
+      else if ( !strcmp(a,"-w") && vhasval ) o.dumpdir = argv[++i];
+      else if ( !strcmp(a,"-c") && vhasval ) o.comparedir = argv[++i];
+      else if ( !strcmp(a,"-e") && vhasval ) o.minsnr = atof( argv[++i] );
+      else if ( !strcmp(a,"-u") ) o.update = true;
+      else if ( !strcmp(a,"-q") ) o.quiet = true;
+      else if ( a[0] != '-' && !o.filter ) o.filter = a;
+      else { Usage(); return 1; }
+   }
+
+   HashMap vhashes;
+   if ( !LoadHashes( o.golden, vhashes ) && !o.update && !o.comparedir ) {
+      fprintf( stderr, "eris_golden: cannot read %s (run with -u to create it)\n", o.golden );
+      return 1;
+   }
+
+   AudioMemory(NUM_MEMORY_BLOCKS);
+
+   if ( !o.quiet && !o.comparedir ) {
+      printf( "float vs fixed, snr dB / max error:\n%-17s", "scenario" );
+      for ( int c=0; c < cNumTapPoints; ++c ) printf( " %14s", Taps::PointName( (TapPoint)c ) );
+      printf( " %14s\n", "out" );
+   }
+
+   int vfailed = 0;
+   int vrun = 0;
+   for ( int i=0; i < cNumScenarios; ++i ) {
+      const Scenario& vscen = cScenarios[i];
+      if ( o.filter && !strstr( vscen.name, o.filter ) ) continue;
+      vrun++;
+
+      Capture vcaptures[2];
+      Run< ErisSynth<FixedPipeline> >( vscen, vcaptures[0] );
+      Run< ErisSynth<FloatPipeline> >( vscen, vcaptures[1] );
+      if ( !o.quiet && !o.comparedir ) Report( vscen.name, vcaptures[0], vcaptures[1] );
+      for ( int p=0; p < 2; ++p ) {
+         vfailed += Check( o, std::string( vscen.name ) + "." + cPipeNames[p], vcaptures[p], vhashes );
+      }
+   }
+
+   if ( o.update && !o.comparedir ) {
+      if ( !SaveHashes( o.golden, vhashes ) ) {
+         fprintf( stderr, "eris_golden: cannot write %s\n", o.golden );
+         return 1;
+      }
+      printf( "%d scenarios -> %s\n", vrun, o.golden );
+      return 0;
+   }
+   if ( vrun == 0 ) {
+      fprintf( stderr, "eris_golden: no scenario matches %s\n", o.filter );
+      return 1;
+   }
+   printf( "%d scenarios, %d stream%s failed\n", vrun, vfailed, vfailed == 1 ? "" : "s" );
+   return vfailed > 0 ? 1 : 0;
+}
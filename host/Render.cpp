@@ -0,0 +1,226 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Offline renderer: runs Eris::update() as fast as possible and writes
+   the transmitted blocks to a 16 bit stereo WAV file.
+
+   usage: eris_render [-o out.wav] [-t seconds] [-n note] [-v velocity]
+                      [-r release_time_s] [-s seed] [-V voices] [-l]
+                      [-m filter_mode] [-M morph] [-f] [-p] [-q]
+
+   -V runs that many voices and plays a chord on them (one note per voice)
+   -l uses Gen2 as an LFO (LO range) on the Gen1 rate and the cutoff
+   -m picks the filter mode: 0 lp, 1 bp, 2 hp, 3 notch, 4 peak, 5 morph
+   -M is the morph position, 0 = lp .. 0.5 = bp .. 1 = hp
+   -f renders the float pipeline instead of the fixed point one
+   -p prints the per-stage profile (needs a build with ERIS_PROFILE=ON)
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#include <time.h>
+#include <vector>
+#include "Arduino.h"
+#include "Eris.h"
+#include "Denormals.h"
+
+static void PutLE( FILE* apFile, uint32_t acValue, int acBytes ){
+   for ( int i=0; i < acBytes; ++i ) fputc( ( acValue >> (8*i) ) & 0xFF, apFile );
+}
+
+static bool WriteWav( const char* apPath, const std::vector<int16_t>& acFrames, uint32_t acRate ){
+   FILE* vfile = fopen( apPath, "wb" );
+   if ( !vfile ) return false;
+   const uint32_t vdatabytes = (uint32_t)( acFrames.size() * sizeof(int16_t) );
+   fwrite( "RIFF", 1, 4, vfile );
+   PutLE( vfile, 36 + vdatabytes, 4 );
+   fwrite( "WAVEfmt ", 1, 8, vfile );
+   PutLE( vfile, 16, 4 );              // fmt chunk size
+   PutLE( vfile, 1, 2 );               // PCM
+   PutLE( vfile, 2, 2 );               // channels
+   PutLE( vfile, acRate, 4 );
+   PutLE( vfile, acRate * 4, 4 );      // byte rate
+   PutLE( vfile, 4, 2 );               // block align
+   PutLE( vfile, 16, 2 );              // bits per sample
+   fwrite( "data", 1, 4, vfile );
+   PutLE( vfile, vdatabytes, 4 );
+   for ( size_t i=0; i < acFrames.size(); ++i ) PutLE( vfile, (uint16_t)acFrames[i], 2 );
+   bool vok = ferror( vfile ) == 0;
+   fclose( vfile );
+   return vok;
+}
+
+static double WallSeconds(){
+   struct timespec ts;
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+struct RenderOptions
+{
+   const char* path{"eris.wav"};
+   float seconds{10.f};
+   float release{-1.f};
+   int note{45};
+   int vel{100};
+   int voices{1};
+   long seed{-1};
+   bool quiet{false};
+   bool profile{false};
+   bool floatpipe{false};
+   bool lfo{false};
+   int filtermode{FilterMode_LowPass};
+   float morph{0.5f};
+};
+
+// same panel state as setup() in Main.cpp
+template <class Synth>
+static void InitPanel( Synth& aModule, bool acLfo ){
+   float vpSeeds[NUM_CONTROL_PTS_MAX];
+   for ( int i=0; i < NUM_CONTROL_PTS_MAX; i++ ) vpSeeds[i] = 0.f;
+   aModule.Init(vpSeeds);
+
+   aModule.SetGen1Rate(0.15f);
+   aModule.SetGen1Dist(1);
+   aModule.SetGen1Gain( 0.5f );
+   aModule.SetGen1Scale(0.3f);
+   aModule.SetGen1Param(0.4f);
+   aModule.SetGen2Rate(0.1f);
+   aModule.SetGen2Dist(1);
+   aModule.SetGen2Gain( 0.5f );
+   aModule.SetGen2Scale(0.6f);
+   aModule.SetGen2Param(0.4f);
+   aModule.SetCutoff(8000.f);
+   aModule.SetResonance(1.f);
+   aModule.SetVCABiasGain(0.f);
+   aModule.SetRateMod(acLfo);
+   aModule.SetCutoffMod(acLfo);
+   aModule.SetGen2ToOut(!acLfo);
+   aModule.SetGen2Range(acLfo);
+   aModule.SyncGens(0);
+}
+
+template <class Synth>
+static int Render( const RenderOptions& o ){
+   // long releases and silent stretches must not crawl through denormals
+   DenormalGuard vguard;
+
+   static Synth module;
+   InitPanel( module, o.lfo );
+   module.SetFilterMode( (FilterMode)o.filtermode );
+   module.SetFilterMorph( o.morph );
+   if ( o.seed >= 0 ) module.Seed( (uint32_t)o.seed );
+
+   const long vnumblocks = (long)ceilf( o.seconds * ERIS_SAMPLE_RATE / AUDIO_BLOCK_SAMPLES );
+   // notes are queued with explicit sample times, so renders don't depend on the wall clock
+   const uint32_t vreleasetime = (uint32_t)( o.release * ERIS_SAMPLE_RATE );
+   const long vreleaseblock = (long)( vreleasetime / AUDIO_BLOCK_SAMPLES );
+   std::vector<int16_t> vframes;
+   vframes.reserve( (size_t)vnumblocks * AUDIO_BLOCK_SAMPLES * 2 );
+
+   static const int cChord[] = { 0, 7, 12, 16, 19, 24, 28, 31, 34, 36, 38, 40, 43, 46, 48, 50 };
+   if ( o.voices > 1 ) {
+      module.SetNumVoices( o.voices );
+      for ( int v=0; v < o.voices; ++v ) module.NoteOnAt( (byte)min( o.note + cChord[v], 127 ), (byte)o.vel, 0 );
+   }
+   else {
+      module.TriggerMidiNoteAt( (byte)o.note, (byte)o.vel, 0 );
+   }
+
+   double vrendertime = 0.0;
+   for ( long b=0; b < vnumblocks; ++b ) {
+      if ( b == vreleaseblock ) {
+         if ( o.voices > 1 ) {
+            for ( int v=0; v < o.voices; ++v ) module.NoteOffAt( (byte)min( o.note + cChord[v], 127 ), vreleasetime );
+         }
+         else {
+            module.TriggerReleaseAt( vreleasetime );
+         }
+      }
+
+      double t0 = WallSeconds();
+      module.update();
+      vrendertime += WallSeconds() - t0;
+
+      audio_block_t* vleft = module.TakeOutput(0);
+      audio_block_t* vright = module.TakeOutput(1);
+      for ( int n=0; n < AUDIO_BLOCK_SAMPLES; ++n ) {
+         vframes.push_back( vleft ? vleft->data[n] : 0 );
+         vframes.push_back( vright ? vright->data[n] : 0 );
+      }
+      AudioStream::release( vleft );
+      AudioStream::release( vright );
+   }
+
+   if ( !WriteWav( o.path, vframes, (uint32_t)( ERIS_SAMPLE_RATE + 0.5f ) ) ) {
+      fprintf( stderr, "eris_render: cannot write %s\n", o.path );
+      return 1;
+   }
+
+   if ( !o.quiet ) {
+      double vaudiotime = (double)vnumblocks * AUDIO_BLOCK_SAMPLES / ERIS_SAMPLE_RATE;
+      printf( "rendered %.2f s (%s pipeline, %d voice%s) in %.3f s (%.1fx real time, %.1f ns/sample) -> %s\n",
+              vaudiotime, o.floatpipe ? "float" : "fixed", o.voices, o.voices > 1 ? "s" : "", vrendertime, vaudiotime / vrendertime,
+              vrendertime * 1e9 / ( (double)vnumblocks * AUDIO_BLOCK_SAMPLES ), o.path );
+   }
+
+   if ( o.profile ) {
+#ifdef ERIS_PROFILE
+      Profiler::Dump( Serial );
+#else
+      fprintf( stderr, "eris_render: built without ERIS_PROFILE\n" );
+#endif
+   }
+   return 0;
+}
+
+static void Usage(){
+   fprintf( stderr, "usage: eris_render [-o out.wav] [-t seconds] [-n note] [-v velocity]"
+                    " [-r release_time_s] [-s seed] [-V voices] [-l]"
+                    " [-m filter_mode] [-M morph] [-f] [-p] [-q]\n" );
+}
+
+int main( int argc, char** argv ){
+   RenderOptions o;
+
+   for ( int i=1; i < argc; ++i ) {
+      const char* a = argv[i];
+      bool vhasval = i + 1 < argc;
+      if ( !strcmp(a,"-o") && vhasval ) o.path = argv[++i];
+      else if ( !strcmp(a,"-t") && vhasval ) o.seconds = (float)atof( argv[++i] );
+      else if ( !strcmp(a,"-n") && vhasval ) o.note = atoi( argv[++i] );
+      else if ( !strcmp(a,"-v") && vhasval ) o.vel = atoi( argv[++i] );
+      else if ( !strcmp(a,"-r") && vhasval ) o.release = (float)atof( argv[++i] );
+      else if ( !strcmp(a,"-s") && vhasval ) o.seed = atol( argv[++i] );
+      else if ( !strcmp(a,"-V") && vhasval ) o.voices = atoi( argv[++i] );
+      else if ( !strcmp(a,"-m") && vhasval ) o.filtermode = atoi( argv[++i] );
+      else if ( !strcmp(a,"-M") && vhasval ) o.morph = (float)atof( argv[++i] );
+      else if ( !strcmp(a,"-l") ) o.lfo = true;
+      else if ( !strcmp(a,"-f") ) o.floatpipe = true;
+      else if ( !strcmp(a,"-p") ) o.profile = true;
+      else if ( !strcmp(a,"-q") ) o.quiet = true;
+      else { Usage(); return 1; }
+   }
+   if ( o.seconds <= 0.f || o.note < 0 || o.note > 127 || o.vel < 0 || o.vel > 127 ||
+        o.voices < 1 || o.voices > ERIS_MAX_VOICES ||
+        o.filtermode < 0 || o.filtermode >= cNumFilterModes ) { Usage(); return 1; }
+   if ( o.release < 0.f ) o.release = 0.8f * o.seconds;
+
+   AudioMemory(NUM_MEMORY_BLOCKS);
+
+   if ( o.floatpipe ) return Render< ErisSynth<FloatPipeline> >( o );
+   return Render< ErisSynth<FixedPipeline> >( o );
+}
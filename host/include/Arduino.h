@@ -0,0 +1,102 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Host shim for the parts of the Teensy/Arduino core used by the DSP
+   modules, so that Eris, GenDyn, VCFixed, VCFloat and AREnv can be built
+   and profiled on a desktop machine.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <utility>
+
+#define ERIS_HOST 1
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+
+#define DMAMEM
+#define FASTRUN
+#define PROGMEM
+
+// no interrupts on the host: the audio callback runs on the caller's thread
+#define __disable_irq() do {} while (0)
+#define __enable_irq() do {} while (0)
+
+typedef uint8_t byte;
+
+template <class A, class B>
+constexpr auto min( A&& a, B&& b ) -> decltype( a < b ? std::forward<A>(a) : std::forward<B>(b) ) {
+   return a < b ? std::forward<A>(a) : std::forward<B>(b);
+}
+
+template <class A, class B>
+constexpr auto max( A&& a, B&& b ) -> decltype( a < b ? std::forward<A>(a) : std::forward<B>(b) ) {
+   return a >= b ? std::forward<A>(a) : std::forward<B>(b);
+}
+
+template <class T, class A, class B, class C, class D>
+T map( T x, A in_min, B in_max, C out_min, D out_max ){
+   return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+uint32_t millis();
+uint32_t micros();
+void delay( uint32_t ms );
+void delayMicroseconds( uint32_t us );
+
+// Minimal Print, enough for the diagnostics written by the DSP modules
+class Print
+{
+public:
+   virtual ~Print(){}
+   virtual size_t write( const char* apStr, size_t acLen ) = 0;
+
+   size_t print( const char* s ){ return write( s, strlen(s) ); }
+   size_t print( char c ){ return write( &c, 1 ); }
+   size_t print( int n ){ return printf_( "%d", n ); }
+   size_t print( unsigned int n ){ return printf_( "%u", n ); }
+   size_t print( long n ){ return printf_( "%ld", n ); }
+   size_t print( unsigned long n ){ return printf_( "%lu", n ); }
+   size_t print( double n, int digits = 2 ){ return printf_( "%.*f", digits, n ); }
+
+   size_t println(){ return write( "\r\n", 2 ); }
+   template <class T> size_t println( T v ){ size_t s = print(v); return s + println(); }
+   size_t println( double n, int digits ){ size_t s = print(n,digits); return s + println(); }
+
+private:
+   size_t printf_( const char* apFmt, ... );
+};
+
+class HostSerial : public Print
+{
+public:
+   void begin( uint32_t ){}
+   size_t write( const char* apStr, size_t acLen ) override {
+      return fwrite( apStr, 1, acLen, stderr );
+   }
+   operator bool(){ return true; }
+};
+
+extern HostSerial Serial;
@@ -0,0 +1,76 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Host shim of the Teensy Audio Library AudioStream base class.
+
+   Blocks come from a fixed pool like on the target. Instead of being
+   routed through AudioConnections, transmitted blocks are parked on the
+   stream outputs, where the host code can pick them up with TakeOutput().
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#ifndef AUDIO_BLOCK_SAMPLES
+#define AUDIO_BLOCK_SAMPLES 128
+#endif
+
+#ifndef AUDIO_SAMPLE_RATE_EXACT
+#define AUDIO_SAMPLE_RATE_EXACT 44117.64706f // same as the Teensy default
+#endif
+
+#define AUDIO_SAMPLE_RATE AUDIO_SAMPLE_RATE_EXACT
+#define AUDIO_MAX_OUTPUTS 2
+
+typedef struct audio_block_struct {
+   uint8_t  ref_count;
+   uint8_t  reserved1;
+   uint16_t memory_pool_index;
+   int16_t  data[AUDIO_BLOCK_SAMPLES];
+} audio_block_t;
+
+#define AudioMemory(num) ({ \
+   static audio_block_t data[num]; \
+   AudioStream::initialize_memory(data, num); \
+})
+
+class AudioStream
+{
+public:
+   AudioStream( unsigned char ninput, audio_block_t **iqueue );
+   virtual ~AudioStream();
+   virtual void update(void) = 0;
+
+   static void initialize_memory( audio_block_t *data, unsigned int num );
+   static void release( audio_block_t *block );
+   static unsigned int memory_used;
+
+   // host only: returns the block last transmitted on output acIndex
+   // (or NULL) and hands its reference over to the caller
+   audio_block_t* TakeOutput( unsigned int acIndex );
+
+protected:
+   static audio_block_t* allocate(void);
+   void transmit( audio_block_t *block, unsigned char index = 0 );
+
+private:
+   static audio_block_t* mpPool;
+   static unsigned int mPoolSize;
+   audio_block_t* mOutput[AUDIO_MAX_OUTPUTS];
+};
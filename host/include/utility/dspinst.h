@@ -0,0 +1,176 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Portable C versions of the Cortex-M DSP instructions wrapped by the
+   Teensy Audio Library (utility/dspinst.h). Each function reproduces the
+   result of the instruction named in its comment bit for bit, so that
+   fixed-point code renders the same on the host as on the target.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+// computes limit((val >> rshift), 2**bits)  (ssat)
+static inline int32_t signed_saturate_rshift( int32_t val, int bits, int rshift )
+{
+   int32_t out = val >> rshift;
+   int32_t max = 1 << (bits - 1);
+   if ( out > max - 1 ) out = max - 1;
+   else if ( out < -max ) out = -max;
+   return out;
+}
+
+// computes limit(val, 2**16)  (ssat 16)
+static inline int16_t saturate16( int32_t val )
+{
+   if ( val > 32767 ) val = 32767;
+   else if ( val < -32768 ) val = -32768;
+   return (int16_t)val;
+}
+
+// computes ((a[31:0] * b[15:0]) >> 16)  (smulwb)
+static inline int32_t signed_multiply_32x16b( int32_t a, uint32_t b )
+{
+   return (int32_t)( ( (int64_t)a * (int16_t)( b & 0xFFFF ) ) >> 16 );
+}
+
+// computes ((a[31:0] * b[31:16]) >> 16)  (smulwt)
+static inline int32_t signed_multiply_32x16t( int32_t a, uint32_t b )
+{
+   return (int32_t)( ( (int64_t)a * (int16_t)( b >> 16 ) ) >> 16 );
+}
+
+// computes (sum + ((a[31:0] * b[15:0]) >> 16))  (smlawb)
+static inline int32_t signed_multiply_accumulate_32x16b( int32_t sum, int32_t a, uint32_t b )
+{
+   return sum + signed_multiply_32x16b( a, b );
+}
+
+// computes (sum + ((a[31:0] * b[31:16]) >> 16))  (smlawt)
+static inline int32_t signed_multiply_accumulate_32x16t( int32_t sum, int32_t a, uint32_t b )
+{
+   return sum + signed_multiply_32x16t( a, b );
+}
+
+// computes ((a[31:0] * b[31:0]) >> 32)  (smmul)
+static inline int32_t multiply_32x32_rshift32( int32_t a, int32_t b )
+{
+   return (int32_t)( ( (int64_t)a * b ) >> 32 );
+}
+
+// computes (((a[31:0] * b[31:0]) + 0x80000000) >> 32)  (smmulr)
+static inline int32_t multiply_32x32_rshift32_rounded( int32_t a, int32_t b )
+{
+   return (int32_t)( ( (int64_t)a * b + 0x80000000LL ) >> 32 );
+}
+
+// computes sum + (((a[31:0] * b[31:0]) + 0x80000000) >> 32)  (smmlar)
+static inline int32_t multiply_accumulate_32x32_rshift32_rounded( int32_t sum, int32_t a, int32_t b )
+{
+   return (int32_t)( ( ( (int64_t)sum << 32 ) + (int64_t)a * b + 0x80000000LL ) >> 32 );
+}
+
+// computes sum - (((a[31:0] * b[31:0]) + 0x80000000) >> 32)  (smmlsr)
+static inline int32_t multiply_subtract_32x32_rshift32_rounded( int32_t sum, int32_t a, int32_t b )
+{
+   return (int32_t)( ( ( (int64_t)sum << 32 ) - (int64_t)a * b + 0x80000000LL ) >> 32 );
+}
+
+// computes (a[31:16] | (b[31:16] >> 16))  (pkhtb)
+static inline uint32_t pack_16t_16t( int32_t a, int32_t b )
+{
+   return ( (uint32_t)a & 0xFFFF0000 ) | ( (uint32_t)b >> 16 );
+}
+
+// computes (a[31:16] | b[15:0])  (pkhtb)
+static inline uint32_t pack_16t_16b( int32_t a, int32_t b )
+{
+   return ( (uint32_t)a & 0xFFFF0000 ) | ( (uint32_t)b & 0x0000FFFF );
+}
+
+// computes ((a[15:0] << 16) | b[15:0])  (pkhbt)
+static inline uint32_t pack_16b_16b( int32_t a, int32_t b )
+{
+   return ( (uint32_t)a << 16 ) | ( (uint32_t)b & 0x0000FFFF );
+}
+
+// computes ((a[15:0] << 16) | b[31:16])  (pkhbt)
+static inline uint32_t pack_16b_16t( int32_t a, int32_t b )
+{
+   return ( (uint32_t)a << 16 ) | ( (uint32_t)b >> 16 );
+}
+
+static inline int32_t saturate_halfword_( int32_t v )
+{
+   if ( v > 32767 ) return 32767;
+   if ( v < -32768 ) return -32768;
+   return v;
+}
+
+// saturating add of both halfwords  (qadd16)
+static inline uint32_t signed_add_16_and_16( uint32_t a, uint32_t b )
+{
+   int32_t lo = saturate_halfword_( (int32_t)(int16_t)a + (int16_t)b );
+   int32_t hi = saturate_halfword_( (int32_t)(int16_t)(a >> 16) + (int16_t)(b >> 16) );
+   return ( (uint32_t)hi << 16 ) | ( (uint32_t)lo & 0xFFFF );
+}
+
+// saturating subtract of both halfwords  (qsub16)
+static inline int32_t signed_subtract_16_and_16( int32_t a, int32_t b )
+{
+   int32_t lo = saturate_halfword_( (int32_t)(int16_t)a - (int16_t)b );
+   int32_t hi = saturate_halfword_( (int32_t)(int16_t)(a >> 16) - (int16_t)(b >> 16) );
+   return (int32_t)( ( (uint32_t)hi << 16 ) | ( (uint32_t)lo & 0xFFFF ) );
+}
+
+// computes (a[15:0] * b[15:0]) + (a[31:16] * b[31:16])  (smuad)
+static inline int32_t multiply_16tx16t_add_16bx16b( uint32_t a, uint32_t b )
+{
+   return (int16_t)a * (int16_t)b + (int16_t)(a >> 16) * (int16_t)(b >> 16);
+}
+
+// computes ((a[15:0] * b[15:0]) + (a[31:16] * b[31:16]) + sum)  (smlad)
+static inline int32_t multiply_accumulate_16tx16t_add_16bx16b( int32_t sum, uint32_t a, uint32_t b )
+{
+   return sum + multiply_16tx16t_add_16bx16b( a, b );
+}
+
+// computes (a[15:0] * b[15:0])  (smulbb)
+static inline int32_t multiply_16bx16b( uint32_t a, uint32_t b )
+{
+   return (int16_t)a * (int16_t)b;
+}
+
+// computes (a[15:0] * b[31:16])  (smulbt)
+static inline int32_t multiply_16bx16t( uint32_t a, uint32_t b )
+{
+   return (int16_t)a * (int16_t)(b >> 16);
+}
+
+// computes (a[31:16] * b[15:0])  (smultb)
+static inline int32_t multiply_16tx16b( uint32_t a, uint32_t b )
+{
+   return (int16_t)(a >> 16) * (int16_t)b;
+}
+
+// computes (a[31:16] * b[31:16])  (smultt)
+static inline int32_t multiply_16tx16t( uint32_t a, uint32_t b )
+{
+   return (int16_t)(a >> 16) * (int16_t)(b >> 16);
+}
@@ -24,51 +24,13 @@
 #include <Arduino.h>
 #include "AudioStream.h"
 #include "utility/dspinst.h"
+#include "ParamSmoother.h"
+#include "ParamBuffer.h"
+#include "SampleRate.h"
 
 #define ENV_PEAK_MAX 32000
 #define GAIN_STEP_PER_FRAME 0.01
-#define GAIN_STEP_PER_SAMPLE 10
-
-// Mult to Const, non-destructive vers
-// signed multiply 32x16 gets:
-// U( 0 + 0 + 1 , 15 + 15 ) = U(1,30) = 31 + sign = 32 bits >> 16 = 16 bits
-inline void MulC( int16_t *dataOut, const int16_t *dataIn, int32_t mult )
-{
-    uint32_t *src = (uint32_t *)dataIn;
-    uint32_t *dst = (uint32_t *)dataOut;
-    const uint32_t *end = (uint32_t *)(dataOut + AUDIO_BLOCK_SAMPLES);
-    
-    do {
-        uint32_t tmp32 = *src++; // read 2 samples from *data
-        int32_t val1 = signed_multiply_32x16b(mult, tmp32);
-        int32_t val2 = signed_multiply_32x16t(mult, tmp32);
-        val1 = signed_saturate_rshift(val1, 16, 0);
-        val2 = signed_saturate_rshift(val2, 16, 0);
-        *dst++ = pack_16b_16b(val2, val1);
-    } while (dst < end);
-}
-
-// In-Place Mult to Const 
-// signed multiply 32x16 gets:
-// U( 0 + 0 + 1 , 15 + 15 ) = U(1,30) = 31 + sign = 32 bits >> 16 = 16 bits
-inline void MulC( int16_t *data, int32_t mult )
-{
-    uint32_t *p = (uint32_t *)data;
-    const uint32_t *end = (uint32_t *)(data + AUDIO_BLOCK_SAMPLES);
-    
-    do {
-        uint32_t tmp32 = *p; // read 2 samples from *data
-
-        int32_t val1 = signed_multiply_32x16b(mult, tmp32);
-        int32_t val2 = signed_multiply_32x16t(mult, tmp32);
-        
-        val1 = signed_saturate_rshift(val1, 16, 0);
-        val2 = signed_saturate_rshift(val2, 16, 0);
-        
-        *p++ = pack_16b_16b(val2, val1);
-        
-    } while (p < end);
-}
+#define GAIN_STEP_PER_SAMPLE gcRate.mGainRamp
 
 enum EnvState
 {
@@ -83,46 +45,56 @@ class AREnv
 
 public:
 
-    AREnv(){}
+    AREnv(){ mBias.SetLinear(GAIN_STEP_PER_SAMPLE); }
     ~AREnv(){}
-   void Process ( audio_block_t *apOut, int acSamples );
+   void Process ( int16_t *apData, int acSamples );
    void TriggerAttack();
    void TriggerRelease();
      
    void SetAttackMs( float acValue ){
-      float vnsamps = acValue * 0.001f * AUDIO_SAMPLE_RATE_EXACT;
-      mAttack_req = (long)vnsamps + 1; // at least 1 sample
+      float vnsamps = acValue * 0.001f * ERIS_SAMPLE_RATE;
+      mParams.Edit().mAttack = (long)vnsamps + 1; // at least 1 sample
+      mParams.Publish();
    }
     
    void SetReleaseMs( float acValue ){
-      float vnsamps = acValue * 0.001f * AUDIO_SAMPLE_RATE_EXACT;
-      mRelease_req = (long)vnsamps + 1; // at least 1 samp 
+      float vnsamps = acValue * 0.001f * ERIS_SAMPLE_RATE;
+      mParams.Edit().mRelease = (long)vnsamps + 1; // at least 1 samp 
+      mParams.Publish();
    }
    
    void SetGain( float acValue ){
-      mPeak_req = (int32_t)( acValue * 65536 );
+      mParams.Edit().mPeak = (int32_t)( acValue * 65536 );
+      mParams.Publish();
    }
 
    void SetBiasGain( float acValue ){
-      mBias_req = (int32_t)( acValue * 65536 );
+      mBias.SetTarget( (int32_t)( acValue * 65536 ) );
    }
 
    bool Done(){ return mState==EnvState_Off; }
+   // no note and the bias settled at 0: Process() would only output zeros
+   bool Silent(){ return mState==EnvState_Off && mBias.Current()==0 && mBias.Target()==0; }
+   bool Releasing(){ return mState==EnvState_Release; }
+   int32_t Level(){ return mCurPeak; } // Q16, without the bias
  
 private:
-   void UpdateGain();
 
     // Params
-    volatile long mAttack_req{1};  // in samps
-    volatile long mRelease_req{1};  // in samps
-    volatile int32_t  mPeak_req{0};
-    volatile int32_t  mBias_req{0}; // bias gain
-    volatile EnvState mState{EnvState_Off};
+    struct Params
+    {
+        long mAttack{1};  // in samps
+        long mRelease{1};  // in samps
+        int32_t mPeak{0};
+    };
+    ParamBuffer<Params> mParams;
+
+    EnvState mState{EnvState_Off};
     
     long mAttack {1}; // in samps
     long mRelease {1}; // in samps
     int32_t mCurPeak {0};
-    int32_t mCurBias {0};
+    ParamSmoother mBias; // bias gain
     int32_t mStep {0};
 };
 
@@ -0,0 +1,64 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Knob response curves, deadband and change detection
+
+   Each knob gets a table of its mapped output (curve and range baked in),
+   looked up with linear interpolation. A new reading only counts when it
+   moves past the deadband, so a still panel dispatches nothing.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#define CONTROL_MAX_KNOBS 16
+#define CONTROL_RAW_MAX 1023 // 10 bit readings
+#define CONTROL_TABLE_SIZE 128 // segments per curve
+#define CONTROL_DEADBAND 2 // raw steps ignored around the last accepted reading
+
+enum ControlCurve
+{
+   ControlCurve_Linear=0,
+   ControlCurve_Square, // x^2, finer at the low end
+   ControlCurve_Exp     // min * (max/min)^x, min and max > 0
+};
+
+class ControlMap
+{
+public:
+   ControlMap();
+
+   void Setup( int acKnob, ControlCurve acCurve, float acMin, float acMax, int acDeadband = CONTROL_DEADBAND );
+
+   // true when the reading moved past the deadband, Value() is then updated
+   bool Update( int acKnob, uint16_t acRaw );
+
+   float Value( int acKnob ){ return mValue[acKnob]; }
+
+   // forget the last readings, the next Update() of every knob reports a change
+   void Invalidate();
+
+private:
+   float Lookup( int acKnob, uint16_t acRaw );
+
+   float mTable[CONTROL_MAX_KNOBS][CONTROL_TABLE_SIZE + 1];
+   float mValue[CONTROL_MAX_KNOBS];
+   int16_t mRaw[CONTROL_MAX_KNOBS]; // last accepted reading, -1 = none
+   int16_t mDeadband[CONTROL_MAX_KNOBS];
+};
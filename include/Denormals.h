@@ -0,0 +1,81 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Denormal protection for the float code
+
+   Recursive float state (the GenDyn dc blocker, the VCFloat integrators)
+   decaying towards zero passes through the denormal range, where x86
+   falls back to microcode and runs 10-100x slower. The Cortex-M7 FPU
+   handles denormals at full speed, but the same code runs on hosts.
+
+   FlushTiny() is applied to such state once per block, so a decay stops
+   at an exact 0 instead of crawling through the denormals. DenormalGuard
+   additionally turns on flush-to-zero in hardware for a scope.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <xmmintrin.h>
+#endif
+
+// ~-300 dB, far below the 16 bit output yet far above the denormals,
+// so a block of decay can't reach them either
+#define DENORMAL_FLUSH_LEVEL 1e-15f
+
+inline float FlushTiny( float acValue ){
+   return ( acValue < DENORMAL_FLUSH_LEVEL && acValue > -DENORMAL_FLUSH_LEVEL ) ? 0.f : acValue;
+}
+
+// FTZ + DAZ (x86 MXCSR) or FZ (ARM FPSCR/FPCR) while in scope,
+// for the calling thread only
+class DenormalGuard
+{
+public:
+   DenormalGuard(){
+      mSaved = Get();
+      Set( mSaved | cFlushBits );
+   }
+   ~DenormalGuard(){ Set( mSaved ); }
+
+   DenormalGuard( const DenormalGuard& ) = delete;
+   DenormalGuard& operator=( const DenormalGuard& ) = delete;
+
+private:
+#if defined(__x86_64__) || defined(__i386__)
+   static const uint64_t cFlushBits = 0x8040; // FTZ | DAZ
+   static uint64_t Get(){ return _mm_getcsr(); }
+   static void Set( uint64_t acValue ){ _mm_setcsr( (unsigned int)acValue ); }
+#elif defined(__aarch64__)
+   static const uint64_t cFlushBits = 1 << 24; // FZ
+   static uint64_t Get(){ uint64_t v; asm volatile( "mrs %0, fpcr" : "=r"( v ) ); return v; }
+   static void Set( uint64_t acValue ){ asm volatile( "msr fpcr, %0" : : "r"( acValue ) ); }
+#elif defined(__ARM_FP)
+   static const uint64_t cFlushBits = 1 << 24; // FZ
+   static uint64_t Get(){ uint32_t v; asm volatile( "vmrs %0, fpscr" : "=r"( v ) ); return v; }
+   static void Set( uint64_t acValue ){ asm volatile( "vmsr fpscr, %0" : : "r"( (uint32_t)acValue ) ); }
+#else
+   static const uint64_t cFlushBits = 0;
+   static uint64_t Get(){ return 0; }
+   static void Set( uint64_t ){}
+#endif
+
+   uint64_t mSaved;
+};
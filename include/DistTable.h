@@ -0,0 +1,91 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Distributions for the GenDyn random walk
+
+   Each distribution maps a uniform random number in [0,1] to [-1,1]
+   (inverse CDF). The transcendental ones (Exponential, Cauchy, Hyperbcos)
+   are sampled into a small table whenever their param changes, so that
+   a breakpoint only costs a linear interpolation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#define DIST_TABLE_SIZE 128 // interp segments
+
+ enum DistId
+ {
+   Linear=0,
+   Exponential=1,
+   Cauchy=2,
+   Hyperbcos=3, 
+   Lfo=4,
+
+   cNumDist
+ };
+
+// the part of a distribution that only depends on its param
+struct DistConsts
+{
+   DistId dist;
+   float param;
+   float k0;
+   float k1;
+};
+
+class DistTable
+{
+public:
+   DistTable(){}
+
+   // exact evaluation
+   static DistConsts Prepare( DistId acDist, float acParam );
+   static float Eval( const DistConsts& acConsts, float acRand, float acLfo );
+
+   // no-op if already built for this dist and param
+   void Build( DistId acDist, float acParam );
+
+   inline float Lookup( float acRand, float acLfo ) const {
+      switch (mDist)
+      {
+         case Linear:
+            return 2.f * (mParam*acRand) - 1.f;
+
+         case Lfo:
+            return 2.f * (mParam*acLfo) - 1.f;
+
+         default:
+         {
+            float vpos = acRand * DIST_TABLE_SIZE;
+            int i = (int)vpos;
+            if ( i > DIST_TABLE_SIZE - 1 ) i = DIST_TABLE_SIZE - 1;
+            float vfrac = vpos - i;
+            return mTable[i] + ( mTable[i+1] - mTable[i] ) * vfrac;
+         }
+      }
+   }
+
+   DistId Dist() const { return mDist; }
+
+private:
+   DistId mDist{Linear};
+   float mParam{1.f};
+   float mTable[DIST_TABLE_SIZE+1];
+};
@@ -23,19 +23,21 @@
 #include "AudioStream.h"
 #include "utility/dspinst.h"
 #include "AREnv.h"
-#include "GenDyn.h"
-//#include "VCFloat.h"
-#include "VCFixed.h"
+#include "ParamSmoother.h"
+#include "Pipeline.h"
 #include "MIDI.h"
+#include "Profiler.h"
+#include "Taps.h"
+#include "EventQueue.h"
 
 #define Q_SCALER_16 32767.0
 #define Q_DIV_16 3e-5
 #define Q_SCALER_32 64536.0
 #define NUM_MEMORY_BLOCKS 50
-#define GAIN_RAMP_STEP 10
-#define SR_DEF 44100.0
+#define GAIN_RAMP_STEP gcRate.mGainRamp
 #define MAX_OSC_GAIN 0.36
 #define MAX_LFO_GAIN 1.f
+#define LFO_SCALE 3 // Gen2 --> Lfo gain
 #define VCF_OCTAVERANGE 7.f
 #define DIV127 1.f/127.f
 
@@ -49,7 +51,7 @@ public:
    TestSine(){}
    
    void set_freq(const float frq){
-      _ph_incr = TWO_PI*frq/AUDIO_SAMPLE_RATE;
+      _ph_incr = TWO_PI*frq/ERIS_SAMPLE_RATE;
    }
 
    void Process ( float *apOut, int acSamples ){
@@ -68,195 +70,330 @@ private:
 };
 
 
-class Eris : public AudioStream
+// Voices the engine can run. Each one costs about as much as the whole
+// monophonic update() did: check "total" in the profiler dump against the
+// block period (AUDIO_BLOCK_SAMPLES / ERIS_SAMPLE_RATE * F_CPU)
+// before raising it. SetNumVoices() picks how many run, up to this.
+#ifndef ERIS_MAX_VOICES
+#define ERIS_MAX_VOICES 8
+#endif
+#if ERIS_MAX_VOICES < 1 || ERIS_MAX_VOICES > 16
+#error "ERIS_MAX_VOICES must be in 1..16" // the mix gain is Q12 over an int32 sum
+#endif
+#define VOICE_NO_NOTE 255
+
+enum VoiceSteal
+{
+   VoiceSteal_Oldest=0,
+   VoiceSteal_Quietest
+};
+
+// panel state common to all the voices, only written by update()
+// (from the event queue), copied by each voice at block start
+struct VoiceShared
+{
+   int32_t mGen1Gain_req{0};
+   int32_t mGen2Gain_req{0};
+   float mGen1Rate_req{0.f};
+   float mGen2Rate_req{0.f};
+   bool  mRateMod{false};
+   bool  mGen2ToOut{false};
+   bool  mSyncGens{false};
+   bool  mGen2Range{false}; // 0=HI 1=LO
+};
+
+template <class Pipeline> class ErisSynth;
+
+// One Gen2 -> Gen1 -> VCF -> AREnv chain. Only the per-note state lives
+// here, the knobs are read from the VoiceShared of the synth.
+template <class Pipeline>
+class ErisVoice
 {
-    
 public:
-    
-    Eris();
-    virtual void update(void);
+   typedef typename Pipeline::Sample Sample;
 
-   // Gen1 Params
-   void SetGen1Rate( float acValue );
-   
-   void SetGen1Scale( float acValue ){
-      __disable_irq();
-      mGen1.SetScale(acValue);
-      __enable_irq();
-   }
+   ErisVoice();
+   void Bind( const VoiceShared* apShared ){ mpShared = apShared; }
+
+   // renders acSamples (up to a block) into apOut
+   void Process( int16_t *apOut, int acSamples );
+
+   void NoteOn( byte acNote, byte acVel, uint32_t acStamp );
+   void NoteOff();
+   void UpdateGen1Rate();
+   void UpdateGen2Rate();
+
+   bool Idle(){ return mAREnv.Done(); }
+   bool Silent(){ return mAREnv.Silent(); }
+   // stands in for Process() while Silent()
+   void Park();
+   bool Releasing(){ return mAREnv.Releasing(); }
+   int32_t Level(){ return mAREnv.Level(); }
+   byte Note(){ return mNote; }
+   uint32_t Stamp(){ return mStamp; }
+
+private:
+   template <class> friend class ErisSynth;
+
+   void SetGen2Partial();
+
+   const VoiceShared* mpShared{NULL};
+   float mMidiFreq_req{0.f};
+   byte mNote{VOICE_NO_NOTE};
+   uint32_t mStamp{0};
+
+   typename Pipeline::Osc mGen1;
+   typename Pipeline::Osc mGen2;
+   typename Pipeline::Filter mVcf;
+   AREnv mAREnv;
+
+   float mLastGen1Val{0.f};
+   float mLastGen2Val{0.f};
+   ParamSmoother mGen1Gain;
+   ParamSmoother mGen2Gain;
+};
+
+#define EVENT_QUEUE_SIZE 128
+#define EVENT_PENDING_SIZE 64 // events taken from the queue, waiting for their time
+
+enum EventType
+{
+   EventType_Param=0,
+   EventType_NoteOn,      // polyphonic, allocates a voice
+   EventType_NoteOff,
+   EventType_MonoNoteOn,  // always voice 0
+   EventType_MonoRelease,
+   EventType_Seed
+};
+
+// everything set from loop() that the audio interrupt reads mid-block
+enum ErisParam
+{
+   ErisParam_Gen1Rate=0,
+   ErisParam_Gen1Scale,
+   ErisParam_Gen1DurScale,
+   ErisParam_Gen1Gain,
+   ErisParam_Gen2Rate,
+   ErisParam_Gen2Scale,
+   ErisParam_Gen2DurScale,
+   ErisParam_Gen2Gain,
+   ErisParam_Gen2ToOut,
+   ErisParam_Gen2Range,
+   ErisParam_SyncGens,
+   ErisParam_RateMod,
+   ErisParam_GainMod,
+   ErisParam_Cutoff,
+   ErisParam_Resonance,
+   ErisParam_CutoffMod,
+   ErisParam_FilterMode,
+   ErisParam_FilterMorph,
+   ErisParam_Attack,
+   ErisParam_Release,
+   ErisParam_BiasGain,
+   ErisParam_NumVoices,
+   ErisParam_VoiceSteal,
+   ErisParam_Oversample,
+
+   cNumErisParams
+};
+
+struct ErisEvent
+{
+   uint32_t mTime;   // sample time, see ErisSynth::Clock()
+   uint8_t mType;    // EventType
+   uint8_t mId;      // note or ErisParam
+   uint8_t mVel;
+   union {
+      float mValue;
+      uint32_t mSeed;
+   };
+};
+
+// Build with -DERIS_FLOAT_PIPELINE to run the oscillators and the filter
+// in float (GenDyn + VCFloat) instead of fixed point (GenDynFixed + VCFixed).
+// Both pipelines are instantiated in Eris.cpp, Eris is the one selected.
+//
+// The setters don't touch the voices: they queue an event that update()
+// applies at its sample offset, splitting the block there. Params take
+// effect at the start of the next block, notes are stamped with Clock()
+// (one block of latency, sample accurate) unless given a time. update()
+// moves the queued events to a list sorted by time, so a note scheduled
+// ahead doesn't hold back what is posted after it; up to
+// EVENT_PENDING_SIZE of them can wait there, the rest stay queued.
+template <class Pipeline>
+class ErisSynth : public AudioStream
+{
+
+public:
+   typedef typename Pipeline::Sample Sample;
+
+   ErisSynth();
+   virtual void update(void);
 
-    void SetGen1Dist( float acValue ){
-      __disable_irq();
-      mGen1.SetDist(acValue);
-      __enable_irq();
+   // Gen1 Params
+   void SetGen1Rate( float acValue ){ PostParam( ErisParam_Gen1Rate, acValue ); }
+   void SetGen1Scale( float acValue ){ PostParam( ErisParam_Gen1Scale, acValue ); }
+
+   void SetGen1Dist( float acValue ){
+      // GenDyn swaps in the rebuilt dist tables atomically,
+      // no need to go through the audio interrupt while they are built.
+      // The other voices share the tables of voice 0.
+      mVoices[0].mGen1.SetDist(acValue);
    }
 
    void SetGen1Param( float acValue ){
-      __disable_irq();
-      mGen1.SetParam(acValue);
-      __enable_irq();
+      mVoices[0].mGen1.SetParam(acValue);
    }
 
-    void SetGen1Gain( float acValue ){
-      mGen1Gain_req = (int32_t)( acValue * Q_SCALER_32 );
+   void SetGen1Gain( float acValue ){ PostParam( ErisParam_Gen1Gain, acValue ); }
+
+   // stochastic durations, off at scale 0
+   void SetGen1DurDist( float acValue ){
+      mVoices[0].mGen1.SetDurDist(acValue);
    }
-   
+   void SetGen1DurScale( float acValue ){ PostParam( ErisParam_Gen1DurScale, acValue ); }
+
    // Gen2 Params
 
-   void SetGen2Rate( float acValue );
+   void SetGen2Rate( float acValue ){ PostParam( ErisParam_Gen2Rate, acValue ); }
 
    void SetGen2Dist( float acValue ){
-      __disable_irq();
-      mGen2.SetDist(acValue);
-      __enable_irq();
+      mVoices[0].mGen2.SetDist(acValue);
    }
 
    void SetGen2Param( float acValue ){
-      __disable_irq();
-      mGen2.SetParam(acValue);
-      __enable_irq();
+      mVoices[0].mGen2.SetParam(acValue);
    }
 
-   void SetGen2Scale( float acValue ){
-      __disable_irq();
-      mGen2.SetScale(acValue);
-      __enable_irq();
-   }
-   
-   void SetGen2Gain( float acValue ){
-      mGen2Gain_req = (int32_t)( acValue * Q_SCALER_32 );
-   }
-   
-   void SetGen2ToOut( bool acValue ){
-      mGen2ToOut = acValue;
-   }
-   
-   // 0=HI 1=LO
-   void SetGen2Range( const bool acValue ){
-      mGen2Range = acValue;
-      mGen2.SetFreqRange(acValue);
-   }
+   void SetGen2Scale( float acValue ){ PostParam( ErisParam_Gen2Scale, acValue ); }
 
-   void SyncGens( const bool acValue ){
-      mSyncGens=acValue;
-   }
+   void SetGen2Gain( float acValue ){ PostParam( ErisParam_Gen2Gain, acValue ); }
 
-    void SetRateMod( bool acValue ){
-      __disable_irq();
-      mRateMod = acValue;
-      __enable_irq();
+   void SetGen2DurDist( float acValue ){
+      mVoices[0].mGen2.SetDurDist(acValue);
    }
+   void SetGen2DurScale( float acValue ){ PostParam( ErisParam_Gen2DurScale, acValue ); }
 
-   void SetGainMod( bool acValue ){
-      __disable_irq();
-      mGainMod = acValue;
-      __enable_irq();
-   }
+   void SetGen2ToOut( bool acValue ){ PostParam( ErisParam_Gen2ToOut, acValue ); }
+
+   // 0=HI 1=LO
+   void SetGen2Range( const bool acValue ){ PostParam( ErisParam_Gen2Range, acValue ); }
+   void SyncGens( const bool acValue ){ PostParam( ErisParam_SyncGens, acValue ); }
+   void SetRateMod( bool acValue ){ PostParam( ErisParam_RateMod, acValue ); }
+   void SetGainMod( bool acValue ){ PostParam( ErisParam_GainMod, acValue ); }
 
    // VCF
-   void SetCutoff( float acValue ){
-      __disable_irq();
-      mVcf.SetCutoff( acValue );
-      __enable_irq();
-   }
+   void SetCutoff( float acValue ){ PostParam( ErisParam_Cutoff, acValue ); }
+   void SetResonance( float acValue ){ PostParam( ErisParam_Resonance, acValue ); }
+   void SetCutoffMod( bool acValue ){ PostParam( ErisParam_CutoffMod, acValue ); }
+   void SetFilterMode( FilterMode acValue ){ PostParam( ErisParam_FilterMode, (float)acValue ); }
+   // Morph mode only, 0 = lp, 0.5 = bp, 1 = hp
+   void SetFilterMorph( float acValue ){ PostParam( ErisParam_FilterMorph, acValue ); }
 
-   void SetResonance( float acValue ){
-      __disable_irq();
-      mVcf.SetResonance( acValue );
-      __enable_irq();
-   }
+   // AREnv
+   void SetAttackMs( float acValue ){ PostParam( ErisParam_Attack, acValue ); }
+   void SetReleaseMs( float acValue ){ PostParam( ErisParam_Release, acValue ); }
 
-   void SetCutoffMod( bool acValue ){
-      __disable_irq();
-      mCutMod = acValue;
+   // Initial Gain (BIAS)
+   void SetVCABiasGain( float acValue ){ PostParam( ErisParam_BiasGain, acValue ); }
 
-      if (acValue==true){
-        mVcf.octaveControl( VCF_OCTAVERANGE );
-      }
-      else{
-        mVcf.octaveControl( 0.f );
-      }  
-      __enable_irq();
+   // MIDI, monophonic: always plays voice 0 (the key buffer is in Main.cpp)
+   void TriggerMidiNote( byte acNote, byte acVel ){ TriggerMidiNoteAt( acNote, acVel, Clock() ); }
+   void TriggerRelease(){ TriggerReleaseAt( Clock() ); }
+   void TriggerMidiNoteAt( byte acNote, byte acVel, uint32_t acTime ){
+      PostEvent( EventType_MonoNoteOn, acNote, acVel, 0.f, acTime );
    }
-
-   // AREnv
-   
-   void SetAttackMs( float acValue ){
-      __disable_irq();
-      mAREnv.SetAttackMs(acValue);
-      __enable_irq();
+   void TriggerReleaseAt( uint32_t acTime ){
+      PostEvent( EventType_MonoRelease, 0, 0, 0.f, acTime );
    }
-    
-   void SetReleaseMs( float acValue ){
-      __disable_irq();
-      mAREnv.SetReleaseMs(acValue);
-      __enable_irq();
+
+   // MIDI, polyphonic: allocates one of the active voices per note
+   void NoteOn( byte acNote, byte acVel ){ NoteOnAt( acNote, acVel, Clock() ); }
+   void NoteOff( byte acNote ){ NoteOffAt( acNote, Clock() ); }
+   void NoteOnAt( byte acNote, byte acVel, uint32_t acTime ){
+      PostEvent( EventType_NoteOn, acNote, acVel, 0.f, acTime );
    }
-   
-   // Initial Gain (BIAS)
-   void SetVCABiasGain( float acValue ){
-       __disable_irq();
-      mVCABiasGain_req = acValue;
-      mAREnv.SetBiasGain(mVCABiasGain_req);
-      __enable_irq();
+   void NoteOffAt( byte acNote, uint32_t acTime ){
+      PostEvent( EventType_NoteOff, acNote, 0, 0.f, acTime );
    }
 
-   // MIDI
-   void TriggerMidiNote( byte acNote, byte acVel );
-   void TriggerRelease();
-         
+   // 1..ERIS_MAX_VOICES
+   void SetNumVoices( int acValue ){ PostParam( ErisParam_NumVoices, (float)acValue ); }
+   void SetVoiceSteal( VoiceSteal acValue ){ PostParam( ErisParam_VoiceSteal, (float)acValue ); }
+   // 1, 2 or 4, Gen1 and Gen2 in the HI range. Each step doubles their cost
+   void SetOversample( int acValue ){ PostParam( ErisParam_Oversample, (float)acValue ); }
+
+   // sample time at which an event posted now gets rendered:
+   // the next block, at the same position the current one has reached
+   uint32_t Clock();
+   // sample time of the first sample of the next block
+   uint32_t SampleTime(){ return mSampleTime; }
+
+   // sends again the param changes that found the queue full, call it from
+   // the loop that turns the knobs: a knob only reports a change once
+   void FlushParams();
+
    inline float GetGen1Val(){ return mLastGen1Val; }
    inline float GetGen2Val(){ return mLastGen2Val; }
 
    void Init(const float* apSeeds){ 
-      mGen1.Init(apSeeds); 
-      mGen2.Init(apSeeds); 
-   }
-private:
-   static void f2fix(const float* apIn, int16_t* apOut, int acsamples){
-      float* src = (float*)apIn; 
-      int16_t* dst = (int16_t*)apOut;
-      const int16_t* oend = (int16_t*)(apOut + acsamples);
-      do {
-         *dst++ = saturate16( (*src++) * Q_SCALER_16 ); 
-      } while (dst < oend);
+      for ( int v=0; v < ERIS_MAX_VOICES; ++v ) {
+         mVoices[v].mGen1.Init(apSeeds,2*v+1);
+         mVoices[v].mGen2.Init(apSeeds,2*v+2);
+      }
    }
-    static void fix2f(const int16_t* apIn, float* apOut, int acsamples){
-      int16_t* src = (int16_t*)apIn; 
-      float* dst = (float*)apOut;
-      const float* oend = (float*)(apOut + acsamples);
-      do {
-         *dst++ = (float) (*src++ / Q_SCALER_16 ); 
-      } while (dst < oend);
+
+   // reproducible random walks, e.g. for offline renders
+   void Seed( uint32_t acSeed ){
+      ErisEvent ev;
+      ev.mTime = mSampleTime;
+      ev.mType = EventType_Seed;
+      ev.mId = 0;
+      ev.mVel = 0;
+      ev.mSeed = acSeed;
+      mEvents.Push( ev );
    }
+
 private:
+   void PostEvent( EventType acType, byte acId, byte acVel, float acValue, uint32_t acTime );
+   void PostParam( ErisParam acParam, float acValue );
+   bool PushParam( ErisParam acParam, float acValue );
+   void ApplyEvent( const ErisEvent& acEvent );
+   void ApplyParam( ErisParam acParam, float acValue );
+   int RenderVoices( int32_t *apSum, int acSamples );
+   int AllocVoice( byte acNote );
 
    // params
-   volatile float mVCABiasGain_req{0.f};
-   volatile int32_t mGen1Gain_req{0};
-   volatile int32_t mGen2Gain_req{0};
-   volatile float mGen1Rate_req{0.f};
-   volatile float mGen2Rate_req{0.f};
-   volatile float mMidiFreq_req{0.f};
-    volatile bool  mGainMod{false};
-    volatile bool  mCutMod{false};
-    volatile bool  mRateMod{false};
-    volatile bool  mGen2ToOut{false};
-    volatile bool  mSyncGens{false};
-    volatile bool  mGen2Range{false}; // 0=HI 1=LO
-
-    GenDyn mGen1;
-    GenDyn mGen2;
-    //VCFloat mVcf;
-    VCFixed mVcf;
-    AREnv mAREnv;
-    
-    // test
-    TestSine msine;
-
-    float mLastGen1Val{0.f};
-    float mLastGen2Val{0.f};
-    int32_t mGen1Gain{0};
-    int32_t mGen2Gain{0};
-    float mVCABiasGain{0.f};
+   VoiceShared mShared;
+   bool  mGainMod{false};
+   bool  mCutMod{false};
+   int   mNumVoices{1};
+   VoiceSteal mVoiceSteal{VoiceSteal_Oldest};
+
+   // loop() -> update()
+   EventQueue<ErisEvent,EVENT_QUEUE_SIZE> mEvents;
+   float mPosted[cNumErisParams]; // last value set per param, producer side
+   bool mPostedValid[cNumErisParams];
+   bool mPostedDirty[cNumErisParams]; // set but not queued yet
+   // update() only, in time order
+   ErisEvent mPending[EVENT_PENDING_SIZE];
+   int mNumPending{0};
+   volatile uint32_t mSampleTime{0};
+   volatile uint32_t mBlockMicros{0};
+
+   ErisVoice<Pipeline> mVoices[ERIS_MAX_VOICES];
+   int32_t mMixGain{4096}; // Q12, 1/sqrt(voices)
+   uint32_t mNoteStamp{0};
+
+   // test
+   TestSine msine;
+
+   float mLastGen1Val{0.f};
+   float mLastGen2Val{0.f};
 };
+
+#ifdef ERIS_FLOAT_PIPELINE
+typedef ErisSynth<FloatPipeline> Eris;
+#else
+typedef ErisSynth<FixedPipeline> Eris;
+#endif
@@ -0,0 +1,67 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Single producer / single consumer lock-free queue
+
+   loop() pushes, the audio interrupt pops. Each side only writes its own
+   index, so no interrupt ever needs to be disabled.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// acSize must be a power of 2, one slot is kept empty
+template <class T, uint32_t acSize>
+class EventQueue
+{
+   static_assert( ( acSize & ( acSize - 1 ) ) == 0, "EventQueue size must be a power of 2" );
+
+public:
+   EventQueue(){}
+
+   // producer side, false when full
+   bool Push( const T& acItem ){
+      const uint32_t vhead = mHead.load( std::memory_order_relaxed );
+      const uint32_t vnext = ( vhead + 1 ) & ( acSize - 1 );
+      if ( vnext == mTail.load( std::memory_order_acquire ) ) return false;
+      mItems[vhead] = acItem;
+      mHead.store( vnext, std::memory_order_release );
+      return true;
+   }
+
+   // consumer side: look at the oldest item without removing it
+   bool Peek( T& aItem ){
+      const uint32_t vtail = mTail.load( std::memory_order_relaxed );
+      if ( vtail == mHead.load( std::memory_order_acquire ) ) return false;
+      aItem = mItems[vtail];
+      return true;
+   }
+
+   // consumer side, only after a successful Peek()
+   void Pop(){
+      const uint32_t vtail = mTail.load( std::memory_order_relaxed );
+      mTail.store( ( vtail + 1 ) & ( acSize - 1 ), std::memory_order_release );
+   }
+
+private:
+   T mItems[acSize];
+   std::atomic<uint32_t> mHead{0}; // written by the producer
+   std::atomic<uint32_t> mTail{0}; // written by the consumer
+};
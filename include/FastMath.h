@@ -0,0 +1,54 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Fast float approximations for the audio rate code
+
+   FastExp2  relative error < 3e-6 (the de Soras exp2 in VCFixed: 0.34%)
+   FastSin   absolute error < 1e-6 on [-pi/2, pi/2]
+
+   Both are plain polynomials on the FPU, no tables, no libm calls.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// 2^x: 2^frac(x) from a degree 4 polynomial (weighted least squares on
+// [0,1], exact at 0), the integer part added to the exponent bits
+inline float FastExp2( float acX )
+{
+   if ( acX < -126.f ) return 0.f;
+   if ( acX > 127.f ) acX = 127.f;
+   int32_t vint = (int32_t)acX; // floor, without a libm call
+   if ( acX < (float)vint ) vint--;
+   const float f = acX - (float)vint;
+   float vpow = 1.f + f * ( 0.693044008f + f * ( 0.241282688f + f * ( 0.0522408969f + f * 0.0134265512f ) ) );
+   uint32_t vbits;
+   memcpy( &vbits, &vpow, sizeof(vbits) );
+   vbits += (uint32_t)vint << 23;
+   memcpy( &vpow, &vbits, sizeof(vbits) );
+   return vpow;
+}
+
+// sin(x) for |x| <= pi/2, odd polynomial of degree 7 (least squares fit)
+inline float FastSin( float acX )
+{
+   const float x2 = acX * acX;
+   return acX * ( 0.999997176f + x2 * ( -0.166649797f + x2 * ( 0.00830743922f + x2 * -0.000183879494f ) ) );
+}
@@ -0,0 +1,55 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Output modes of the state variable filters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+// range of the modulated corner, the same in VCFixed and VCFloat
+#define CUTOFF_MIN 40.f
+#define CUTOFF_MAX 8000.f
+
+enum FilterMode
+{
+   FilterMode_LowPass=0,
+   FilterMode_BandPass,
+   FilterMode_HighPass,
+   FilterMode_Notch,    // lp + hp
+   FilterMode_Peak,     // lp - hp
+   FilterMode_Morph,    // lp -> bp -> hp, see FilterMorph()
+
+   cNumFilterModes
+};
+
+// weights of the lp, bp and hp outputs for a morph position in [0,1]:
+// 0 = lp, 0.5 = bp, 1 = hp, crossfading in between
+inline void FilterMorph( float acPos, float& aLp, float& aBp, float& aHp ){
+   if ( acPos < 0.f ) acPos = 0.f;
+   else if ( acPos > 1.f ) acPos = 1.f;
+   if ( acPos < 0.5f ) {
+      aLp = 1.f - 2.f * acPos;
+      aBp = 2.f * acPos;
+      aHp = 0.f;
+   }
+   else {
+      aLp = 0.f;
+      aBp = 2.f - 2.f * acPos;
+      aHp = 2.f * acPos - 1.f;
+   }
+}
@@ -8,8 +8,14 @@
     the Supercollider version by Nick Collins, see:
     https://github.com/supercollider/supercollider/blob/develop/server/plugins/GendynUGens.cpp
 
-    + in this version, only the amplitudes are modulated by the stochastic 
-    process, not the durations.
+    + the amplitudes and the durations of the segments follow two random
+    walks, each with its own distribution. The duration walk moves the
+    step of each segment within +-DurRange octaves of the set frequency.
+    At DurScale 0 the segments keep the same length.
+
+    + optionally oversampled (SetOversample): the walk runs at 2x or 4x
+    the sample rate, with up to 2x/4x the control points at high freqs,
+    and halfband decimators (Halfband.h) bring it back. HI range only.
 
     + The 5 distributions are interpolated by mean of the "Dist" parameter
 
@@ -34,18 +40,36 @@
 #include <Arduino.h>
 #include "AudioStream.h"
 #include "utility/dspinst.h"
+#include "DistTable.h"
+#include "Rng.h"
+#include "ParamBuffer.h"
+#include "Denormals.h"
+#include "FastMath.h"
+#include "Halfband.h"
+#include "SampleRate.h"
 
 #define FREQ_RAMP_STEP_FRACT 0.1f
 #define FREQ_MIN 20
 #define FREQ_MAX 4500
 #define LFO_FREQ_MIN 0.05f
 #define LFO_FREQ_MAX 20.f
+#define LFO_DECIM 16 // ProcessLfo() evaluates one sample in LFO_DECIM
+#define LFO_DECIM_SHIFT 4
+#define DC_COEF gcRate.mDcCoef
+#define LFO_DC_COEF gcRate.mDcCoefLfo // same dc blocker at the lower rate
 #define PARAM_MIN 0.00001f
 #define PARAM_MAX 1.f
 #define SCALE_MIN 0.025f
 #define SCALE_MAX 1.f
 #define NUM_CONTROL_PTS_MAX 20
 #define NUM_CONTROL_PTS_MIN 3
+#define PARAM_EPS 0.0005f // smaller param changes don't rebuild the dist tables
+#define RAND_BLOCK_SIZE 32 // random numbers drawn per refill
+#define DUR_SCALE_MAX 1.f
+#define DUR_RANGE_MAX 2.f // octaves
+#define DUR_RANGE_DEF 1.f
+#define OVERSAMPLE_MAX 4
+#define OVERSAMPLE_CHUNK 32 // output samples rendered per pass when oversampling
 
 // we have 5 distributions
 // divide the range in 4 interp sectors
@@ -56,72 +80,125 @@
 #define DIST_PARAM_THRES_3 0.75
 #define DIST_PARAM_THRES_4 1.0 // to catch the lfo
 
-static const double cLehmerCoef1 = 1.17f; 
-static const double cLehmerCoef2 = 0.31f;     
-    
 inline const float Clip(float acValue,const float min, const float max){
     float vout = acValue < min ? min : acValue;
     vout = acValue > max ? max : acValue;
     return vout;
 }
 
- enum DistId
- {
-   Linear=0,
-   Exponential=1,
-   Cauchy=2,
-   Hyperbcos=3, 
-   Lfo=4,
-
-   cNumDist
- };
-
 class GenDyn
 {
 
 public:
     GenDyn(){}
     ~GenDyn(){}
-   void Init(const float* apSeeds);
+   // seeds the random walk from NUM_CONTROL_PTS_MAX values (or NULL);
+   // acStream keeps oscillators sharing the same seeds apart
+   void Init(const float* apSeeds, uint32_t acStream = 0);
+   void Seed( uint32_t acSeed );
+   // apCtl may be NULL (no FM, Lfo dist sees 0)
    void Process ( float *apOut, float *apCtl, float acFMAmount, int acSamples );
+   // control rate, for the LO range: the walk runs at SR / LFO_DECIM and
+   // is expanded by linear ramps, one LFO_DECIM late. No FM.
+   void ProcessLfo ( float *apOut, int acSamples );
    void SetFreq( float acValue ); 
    void SetFreqNorm( float acValue ); // normalized in range min-max
    void SetFreqRange( int acValue ); // 0=hi 1=lo
    void SetDist( float acValue );
    void SetScale( float acValue );
    void SetParam( float acValue );
-   void SetSamplerate( float acValue );
-   float FreqNorm(){ return mFreqNorm; }
-   float Freq(){ return mFreq; }
-
-private:
+   // duration walk: own dist (same 0..1 mapping as SetDist), step, and
+   // mirroring bounds in octaves around the set frequency
+   void SetDurDist( float acValue );
+   void SetDurScale( float acValue );
+   void SetDurRange( float acValue );
+   // 1, 2 or 4. Ignored in the LO range and by ProcessLfo()
+   void SetOversample( int acValue );
+   // read the dist tables of aOwner instead of our own, SetDist() and
+   // SetParam() then only need to be called on the owner
+   void ShareDist( const GenDyn& aOwner ){ mpDistOwner = &aOwner; }
+   float FreqNorm(){ return mParams.Front().mFreqNorm; }
+   float Freq(){ return mParams.Front().mFreq; }
+
+protected:
+    struct DistSet;
     float ComputeInterpDist( float acParam2, float acLfo );
-    float ComputeDist(  DistId acDist,
-                         float acParam1, 
-                        float acParam2, 
-                        float acLfo );
-
+    static float InterpDist( const DistSet& acSet, float acParam2, float acLfo );
+    static void SplitDist( float acValue, DistId& aDist1, DistId& aDist2, float& aMix );
+    void PublishDist();
+    void PublishDurDist();
+    // step of the current segment from the step of the set frequency
+    inline float SegmentDx( float acDx ) const {
+        float vdx = acDx * mDurMul;
+        return vdx >= 0.99f ? 0.99f : vdx;
+    }
+
+    // the walk at the rate in mBlock, Process() without the oversampling
+    void Render( float *apOut, const float *apCtl, float acFMAmount, int acSamples );
+    // oversampling factor of this block, mBlock set up for the internal rate.
+    // aRestart: the factor changed, the decimators hold stale history
+    int BeginOversample( bool& aRestart );
+    void NewSegment( float acCtl );
+    inline float NextRandom(){
+        if ( mRandPos >= RAND_BLOCK_SIZE ) {
+            mRng.Fill( mRand, RAND_BLOCK_SIZE );
+            mRandPos = 0;
+        }
+        return mRand[mRandPos++];
+    }
+    void UpdateNumKP( float acFreq );
     float mirroring( float in, const float acLimit );
     float LagrangeInterp( float x,float y0,float y1,float y2 );
     float LinearInterp( float x,float y0,float y1 );
 
-private:
+protected:
   
-    // Params
-    volatile float mSR{AUDIO_SAMPLE_RATE_EXACT};
-    volatile float mFreq{440.f};
-    volatile float mFreqNorm{0.f};
-    volatile float mDistParam{0.f}; 
-    volatile float mParam{1.f};
-    volatile float mScale{0.5f};
-    volatile int mFreqRange{0}; // 0=hi, 1=lo 
+    // Params, written by the setters, read once per Process()
+    struct Params
+    {
+        float mSR{ERIS_SAMPLE_RATE};
+        float mInvSR{1.f/ERIS_SAMPLE_RATE};
+        float mFreq{440.f};
+        float mFreqNorm{0.f};
+        float mScale{0.5f};
+        float mFreqMin{FREQ_MIN};
+        float mFreqMax{FREQ_MAX};
+        int mFreqRange{0}; // 0=hi, 1=lo 
+        float mDurScale{0.f};
+        float mDurRange{DUR_RANGE_DEF};
+        int mOversample{1};
+    };
+    ParamBuffer<Params> mParams;
+    Params mBlock; // front copy for the current block
+
+    // dist settings, control side only (the audio side reads mDistSet)
+    float mDistParam{0.f}; 
+    float mParam{1.f};
     
     // Runtime Vars
     DistId mDist1{Linear};
     DistId mDist2{Linear};
+    DistId mDurDist1{Linear};
+    DistId mDurDist2{Linear};
+    float mDurDistParam{0.f};
+
+    // tables for the active dist pair
+    struct DistSet
+    {
+        DistTable mTable1;
+        DistTable mTable2;
+        float mMix{0.f};
+    };
+    ParamBuffer<DistSet> mDistSet;
+    ParamBuffer<DistSet> mDurDistSet;
+    const GenDyn* mpDistOwner{this};
+
     float my0{0.f}; 
     float my1{0.f}; 
     float my2{0.f}; 
+    float mC0{0.f}; // interpolation polynomial of the current segment
+    float mC1{0.f}; 
+    float mC2{0.f}; 
     float mdx{0.f};
     float mdxmin{0.f};
     float mdxmax{0.f};
@@ -129,9 +206,20 @@ private:
     int16_t mIndex{0}; 
     float mY[NUM_CONTROL_PTS_MAX];
     float mdY[NUM_CONTROL_PTS_MAX];
+    float mDurY[NUM_CONTROL_PTS_MAX]; // duration walk, in [-1, 1]
+    float mDurMul{1.f}; // step multiplier of the current segment
     int mNumKP{8};
     float mPrevVal{0.f};
     float mPrevOut{0.f};
-    float mFreqMin{FREQ_MIN};
-    float mFreqMax{FREQ_MAX};
+    int mLfoCount{0}; // samples left before the next control rate step
+    float mLfoCur{0.f};
+    float mLfoInc{0.f};
+    float mLfoNext{0.f};
+    Rng mRng;
+    float mRand[RAND_BLOCK_SIZE];
+    int mRandPos{RAND_BLOCK_SIZE};
+
+    int mOversampleRun{1}; // factor of the previous block
+    HalfbandFloat<HALFBAND_LONG> mDecim2;
+    HalfbandFloat<HALFBAND_SHORT> mDecim4;
 };
@@ -0,0 +1,81 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   GenDyn Oscillator, fixed point rendering
+
+   Same random walk as GenDyn (distributions, mirroring, control points
+   are updated in float, once per breakpoint), but the per sample work -
+   phase, Lagrange interpolation and DC blocking - is done in fixed point
+   and the output is written straight to an int16_t block.
+
+    phase x        Q31, unsigned (x >= 1 when bit 31 is set)
+    interp coeffs  Q28
+    dc blocker     Q28
+    out, ctl       Q15
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include "GenDyn.h"
+
+#define Q28_ONE 268435456.f
+#define Q31_ONE 2147483648.f
+#define PHASE_ONE 0x80000000u
+#define DC_COEF_Q31 gcRate.mDcCoefQ31
+#define DC_COEF_LFO_Q31 gcRate.mDcCoefLfoQ31
+
+class GenDynFixed : public GenDyn
+{
+public:
+    GenDynFixed(){}
+    ~GenDynFixed(){}
+
+    // ctl is Q15 (full scale = 1.0), apCtl may be NULL
+    void Process ( int16_t *apOut, const int16_t *apCtl, float acFMAmount, int acSamples );
+    // see GenDyn::ProcessLfo(), the ramps are Q28
+    void ProcessLfo ( int16_t *apOut, int acSamples );
+
+private:
+    void Render ( int16_t *apOut, const int16_t *apCtl, float acFMAmount, int acSamples );
+
+    void NewSegmentFixed( int16_t acCtl ){
+        NewSegment( acCtl * (1.f/32768.f) );
+        mQ0 = (int32_t)( mC0 * Q28_ONE );
+        mQ1 = (int32_t)( mC1 * Q28_ONE );
+        mQ2 = (int32_t)( mC2 * Q28_ONE );
+    }
+
+    // c0 + x * ( c1 + x * c2 ), x Q31, c Q28
+    static inline int32_t Interp( uint32_t x, int32_t c0, int32_t c1, int32_t c2 ){
+        int32_t t = c1 + ( multiply_32x32_rshift32( (int32_t)x, c2 ) << 1 );
+        return c0 + ( multiply_32x32_rshift32( (int32_t)x, t ) << 1 );
+    }
+
+    uint32_t mPhase{PHASE_ONE};
+    int32_t mQ0{0};
+    int32_t mQ1{0};
+    int32_t mQ2{0};
+    int32_t mPrevValQ{0};
+    int32_t mPrevOutQ{0};
+    int32_t mLfoCurQ{0};
+    int32_t mLfoIncQ{0};
+    int32_t mLfoNextQ{0};
+
+    HalfbandQ15<HALFBAND_LONG> mDecim2Q;
+    HalfbandQ15<HALFBAND_SHORT> mDecim4Q;
+};
@@ -0,0 +1,170 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Halfband decimators for the oversampled oscillators
+
+   Symmetric halfband FIR, decimating by 2, in polyphase form: every
+   other tap is zero, so the even input phase goes through a tTaps long
+   branch and the odd phase only through the center tap (0.5), delayed.
+   Designed at 44.1 kHz out (Kaiser window):
+
+    HALFBAND_LONG   2x -> 1x, flat to 16 kHz, > 62 dB below from 28 kHz
+    HALFBAND_SHORT  4x -> 2x, > 67 dB over what folds below 16 kHz
+
+   The float version is for GenDyn, the Q15 one for GenDynFixed: the
+   branch coefficients are packed in pairs for the dual 16 bit MACs
+   (smlad) and the input phases are split with pkhbt/pkhtb.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "utility/dspinst.h"
+
+#define HALFBAND_LONG 16 // branch taps
+#define HALFBAND_SHORT 8
+#define HALFBAND_CHUNK 64 // output samples per pass, sizes the stack buffers
+
+template <int tTaps>
+struct HalfbandCoefs
+{
+   static const float cFloat[tTaps];
+   static const uint32_t cPacked[tTaps/2]; // Q15, top = tap 2p, bottom = tap 2p+1
+};
+
+template <> const float HalfbandCoefs<HALFBAND_LONG>::cFloat[HALFBAND_LONG];
+template <> const uint32_t HalfbandCoefs<HALFBAND_LONG>::cPacked[HALFBAND_LONG/2];
+template <> const float HalfbandCoefs<HALFBAND_SHORT>::cFloat[HALFBAND_SHORT];
+template <> const uint32_t HalfbandCoefs<HALFBAND_SHORT>::cPacked[HALFBAND_SHORT/2];
+
+// 2*acOut samples in, acOut out. apIn and apOut may be the same buffer.
+template <int tTaps>
+class HalfbandFloat
+{
+public:
+   HalfbandFloat(){ Reset(); }
+
+   void Reset(){
+      for ( int i=0; i < tTaps-1; ++i ) mEven[i] = 0.f;
+      for ( int i=0; i < tTaps/2; ++i ) mOdd[i] = 0.f;
+   }
+
+   void Process( const float *apIn, float *apOut, int acOut ){
+      const float* c = HalfbandCoefs<tTaps>::cFloat;
+      float ve[tTaps-1 + HALFBAND_CHUNK];
+      float vo[tTaps/2 + HALFBAND_CHUNK];
+
+      while ( acOut > 0 )
+      {
+         const int vn = acOut < HALFBAND_CHUNK ? acOut : HALFBAND_CHUNK;
+         acOut -= vn;
+
+         // history, then the two phases of the new input
+         memcpy( ve, mEven, sizeof(mEven) );
+         memcpy( vo, mOdd, sizeof(mOdd) );
+         for ( int m=0; m < vn; ++m ) {
+            ve[tTaps-1 + m] = apIn[2*m];
+            vo[tTaps/2 + m] = apIn[2*m+1];
+         }
+         apIn += 2*vn;
+
+         for ( int m=0; m < vn; ++m ) {
+            const float* e = &ve[tTaps-1 + m];
+            float vacc = 0.5f * vo[m];
+            for ( int j=0; j < tTaps; ++j ) vacc += c[j] * e[-j];
+            *apOut++ = vacc;
+         }
+
+         memcpy( mEven, &ve[vn], sizeof(mEven) );
+         memcpy( mOdd, &vo[vn], sizeof(mOdd) );
+      }
+   }
+
+private:
+   float mEven[tTaps-1]; // last inputs of the branch
+   float mOdd[tTaps/2];  // the odd phase, delayed to the center of the branch
+};
+
+// Q15 in and out, see HalfbandFloat
+template <int tTaps>
+class HalfbandQ15
+{
+public:
+   HalfbandQ15(){ Reset(); }
+
+   void Reset(){
+      for ( int i=0; i < tTaps-1; ++i ) mEven[i] = 0;
+      for ( int i=0; i < tTaps/2; ++i ) mOdd[i] = 0;
+   }
+
+   void Process( const int16_t *apIn, int16_t *apOut, int acOut ){
+      const uint32_t* c = HalfbandCoefs<tTaps>::cPacked;
+      int16_t ve[tTaps-1 + HALFBAND_CHUNK];
+      int16_t vo[tTaps/2 + HALFBAND_CHUNK];
+
+      while ( acOut > 0 )
+      {
+         const int vn = acOut < HALFBAND_CHUNK ? acOut : HALFBAND_CHUNK;
+         acOut -= vn;
+
+         memcpy( ve, mEven, sizeof(mEven) );
+         memcpy( vo, mOdd, sizeof(mOdd) );
+         int m = 0;
+         for ( ; m + 1 < vn; m += 2 ) {
+            // (e0,o0) (e1,o1) -> (e0,e1) (o0,o1)
+            const uint32_t w0 = Load2( &apIn[2*m] );
+            const uint32_t w1 = Load2( &apIn[2*m+2] );
+            Store2( &ve[tTaps-1 + m], pack_16b_16b( w1, w0 ) );
+            Store2( &vo[tTaps/2 + m], pack_16t_16t( w1, w0 ) );
+         }
+         if ( m < vn ) {
+            ve[tTaps-1 + m] = apIn[2*m];
+            vo[tTaps/2 + m] = apIn[2*m+1];
+         }
+         apIn += 2*vn;
+
+         for ( m=0; m < vn; ++m ) {
+            const int16_t* e = &ve[tTaps-1 + m];
+            int32_t vacc = ( (int32_t)vo[m] << 14 ) + ( 1 << 14 ); // center tap, rounding
+            for ( int p=0; p < tTaps/2; ++p ) {
+               // e[-2p-1] in the bottom half, e[-2p] in the top
+               vacc = multiply_accumulate_16tx16t_add_16bx16b( vacc, Load2( e - 2*p - 1 ), c[p] );
+            }
+            *apOut++ = saturate16( vacc >> 15 );
+         }
+
+         memcpy( mEven, &ve[vn], sizeof(mEven) );
+         memcpy( mOdd, &vo[vn], sizeof(mOdd) );
+      }
+   }
+
+private:
+   // unaligned halfword pairs, a single ldr/str on the M7
+   static inline uint32_t Load2( const int16_t* apSrc ){
+      uint32_t v;
+      memcpy( &v, apSrc, sizeof(v) );
+      return v;
+   }
+   static inline void Store2( int16_t* apDst, uint32_t acValue ){
+      memcpy( apDst, &acValue, sizeof(acValue) );
+   }
+
+   int16_t mEven[tTaps-1];
+   int16_t mOdd[tTaps/2];
+};
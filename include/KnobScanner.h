@@ -0,0 +1,75 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Background knob scanner (Teensy only)
+
+   An IntervalTimer starts one conversion per ADC every tick: ADC0 reads
+   the multiplexer output, ADC1 one of the direct analog pins. The
+   conversion-complete interrupts filter the result and, for the mux,
+   select the next channel, which then has a whole tick to settle.
+   loop() only reads the published values.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#define KNOB_MUX_CHANNELS 8
+#define KNOB_MUX_SELECT_PINS 3
+#define KNOB_MAX_DIRECT 8
+#define KNOB_MAX_CHANNELS ( KNOB_MUX_CHANNELS + KNOB_MAX_DIRECT )
+#define KNOB_SCAN_PERIOD_US 250  // per tick: one mux channel + one direct pin
+#define KNOB_FILTER_SHIFT 3      // one-pole, y += (x - y) / 8 per reading
+#define KNOB_IRQ_PRIORITY 224    // below the audio update (208)
+#define KNOB_RESOLUTION 10       // values are 0..1023
+
+class KnobScanner
+{
+public:
+   // channels 0..7 are the mux inputs (in mux order), then the direct pins
+   static void Begin( int acMuxPin, const int* apSelectPins, const int* apDirectPins, int acNumDirect );
+
+   // latest filtered value, 0..1023
+   static inline uint16_t Value( int acChannel ){ return mValue[acChannel]; }
+
+   // completed passes over every channel
+   static inline uint32_t Scans(){ return mScans; }
+
+   static int NumChannels(){ return KNOB_MUX_CHANNELS + mNumDirect; }
+
+private:
+   static void Tick();
+   static void MuxDone();
+   static void DirectDone();
+   static void SelectMux( int acChannel );
+   static void Filter( int acChannel, int acRaw );
+
+   static int mMuxPin;
+   static int mSelectPins[KNOB_MUX_SELECT_PINS];
+   static int mDirectPins[KNOB_MAX_DIRECT];
+   static int mNumDirect;
+
+   static volatile uint16_t mValue[KNOB_MAX_CHANNELS];
+   static volatile uint32_t mScans;
+   static uint32_t mState[KNOB_MAX_CHANNELS]; // filter state, Q16
+   static bool mPrimed[KNOB_MAX_CHANNELS];
+   static int mMuxChannel;
+   static int mDirectChannel;
+   static bool mMuxBusy;
+   static bool mDirectBusy;
+};
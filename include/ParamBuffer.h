@@ -0,0 +1,56 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Double-buffered parameter set
+
+   The control side edits the back copy and publishes it by flipping the
+   front index, the audio side reads the front once per block. A block
+   never sees half of an update, and the DSP loops work on plain locals
+   instead of volatile members.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// One writer, one reader. The writer may be interrupted by the reader
+// (loop() and the audio interrupt), not the other way round.
+template <class T>
+class ParamBuffer
+{
+public:
+   ParamBuffer(){}
+
+   // control side: the back copy, always up to date with the front
+   T& Edit(){ return mBuf[ mFront.load( std::memory_order_relaxed ) ^ 1 ]; }
+
+   // control side: swap in what was edited, then resync the new back copy
+   void Publish(){
+      const uint8_t vfront = mFront.load( std::memory_order_relaxed ) ^ 1;
+      mFront.store( vfront, std::memory_order_release );
+      mBuf[vfront ^ 1] = mBuf[vfront];
+   }
+
+   // audio side
+   const T& Front() const { return mBuf[ mFront.load( std::memory_order_acquire ) ]; }
+
+private:
+   T mBuf[2];
+   std::atomic<uint8_t> mFront{0};
+};
@@ -0,0 +1,179 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Block-rate parameter smoothing
+
+   The ramp is worked out once per block (where the value starts and how
+   much it moves per sample), so the sample loops only add the increment.
+   Gains are applied two samples at a time with the 32x16 multiplies.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "AudioStream.h"
+#include "utility/dspinst.h"
+
+#define SMOOTH_GAIN_ONE 65536 // gains are Q16
+
+// Mult to Const, non-destructive vers
+// signed multiply 32x16 gets:
+// U( 0 + 0 + 1 , 15 + 15 ) = U(1,30) = 31 + sign = 32 bits >> 16 = 16 bits
+inline void MulC( int16_t *dataOut, const int16_t *dataIn, int32_t mult, int acSamples = AUDIO_BLOCK_SAMPLES )
+{
+    uint32_t *src = (uint32_t *)dataIn;
+    uint32_t *dst = (uint32_t *)dataOut;
+    const uint32_t *end = (uint32_t *)(dataOut + ( acSamples & ~1 ));
+
+    while (dst < end) {
+        uint32_t tmp32 = *src++; // read 2 samples from *data
+        int32_t val1 = signed_multiply_32x16b(mult, tmp32);
+        int32_t val2 = signed_multiply_32x16t(mult, tmp32);
+        val1 = signed_saturate_rshift(val1, 16, 0);
+        val2 = signed_saturate_rshift(val2, 16, 0);
+        *dst++ = pack_16b_16b(val2, val1);
+    }
+    if ( acSamples & 1 ) {
+        dataOut[acSamples-1] = signed_saturate_rshift( signed_multiply_32x16b( mult, dataIn[acSamples-1] ), 16, 0 );
+    }
+}
+
+// In-Place Mult to Const
+// signed multiply 32x16 gets:
+// U( 0 + 0 + 1 , 15 + 15 ) = U(1,30) = 31 + sign = 32 bits >> 16 = 16 bits
+inline void MulC( int16_t *data, int32_t mult, int acSamples = AUDIO_BLOCK_SAMPLES )
+{
+    MulC( data, data, mult, acSamples );
+}
+
+// In-Place Mult to a ramp: sample n gets acStart + (n+1) * acInc
+inline void MulRamp( int16_t *data, int32_t acStart, int32_t acInc, int acSamples )
+{
+    uint32_t *p = (uint32_t *)data;
+    const uint32_t *end = (uint32_t *)(data + ( acSamples & ~1 ));
+    int32_t mult = acStart;
+
+    while (p < end) {
+        uint32_t tmp32 = *p; // read 2 samples from *data
+        mult += acInc;
+        int32_t val1 = signed_multiply_32x16b(mult, tmp32);
+        mult += acInc;
+        int32_t val2 = signed_multiply_32x16t(mult, tmp32);
+        val1 = signed_saturate_rshift(val1, 16, 0);
+        val2 = signed_saturate_rshift(val2, 16, 0);
+        *p++ = pack_16b_16b(val2, val1);
+    }
+    if ( acSamples & 1 ) {
+        mult += acInc;
+        data[acSamples-1] = signed_saturate_rshift( signed_multiply_32x16b( mult, data[acSamples-1] ), 16, 0 );
+    }
+}
+
+enum SmoothMode
+{
+   SmoothMode_Linear=0, // fixed step per sample
+   SmoothMode_Exp       // fixed fraction of the distance per sample
+};
+
+class ParamSmoother
+{
+public:
+   ParamSmoother(){}
+
+   // linear: moves at most acStep per sample
+   void SetLinear( int32_t acStep ){
+      mMode = SmoothMode_Linear;
+      mRate = acStep;
+   }
+
+   // exponential: moves acCoef (Q16) of the distance left per sample
+   void SetExp( int32_t acCoef ){
+      mMode = SmoothMode_Exp;
+      mRate = acCoef;
+   }
+
+   void SetTarget( int32_t acValue ){ mTarget = acValue; }
+
+   // jump to acValue, no ramp
+   void Reset( int32_t acValue ){
+      mTarget = acValue;
+      mCurrent = acValue;
+      mStart = acValue;
+      mInc = 0;
+   }
+
+   // works out the ramp of the next acSamples:
+   // sample n of the block gets Start() + (n+1) * Inc()
+   void NextBlock( int acSamples ){
+      const int32_t vdiff = mTarget - mCurrent;
+      int32_t vmove;
+      if ( mMode == SmoothMode_Linear ) {
+         const int32_t vmax = mRate * acSamples;
+         vmove = vdiff > vmax ? vmax : ( vdiff < -vmax ? -vmax : vdiff );
+      }
+      else {
+         int32_t vcoef = mRate * acSamples;
+         if ( vcoef > SMOOTH_GAIN_ONE ) vcoef = SMOOTH_GAIN_ONE;
+         vmove = (int32_t)( ( (int64_t)vdiff * vcoef ) >> 16 );
+         if ( vmove == 0 ) vmove = vdiff; // close enough, land on the target
+      }
+
+      mStart = mCurrent;
+      mInc = vmove / acSamples;
+      if ( mInc == 0 ) {
+         // less than one unit per sample left
+         mCurrent += vmove;
+         mStart = mCurrent;
+      }
+      else {
+         mCurrent += mInc * acSamples;
+      }
+   }
+
+   int32_t Start(){ return mStart; }
+   int32_t Inc(){ return mInc; }
+   int32_t Current(){ return mCurrent; }
+   int32_t Target(){ return mTarget; }
+   bool Ramping(){ return mInc != 0; }
+
+   // Q16 gain, in place: one block of the ramp, or a plain MulC when settled
+   void Apply( int16_t *apData, int acSamples ){
+      NextBlock( acSamples );
+      if ( mInc == 0 ) MulC( apData, mStart, acSamples );
+      else MulRamp( apData, mStart, mInc, acSamples );
+   }
+
+   void Apply( float *apData, int acSamples ){
+      NextBlock( acSamples );
+      const float vscale = 1.f / SMOOTH_GAIN_ONE;
+      float vgain = mStart * vscale;
+      const float vinc = mInc * vscale;
+      for ( int n=0; n < acSamples; ++n ) {
+         vgain += vinc;
+         apData[n] *= vgain;
+      }
+   }
+
+private:
+   int32_t mTarget{0};
+   int32_t mCurrent{0};
+   int32_t mStart{0};
+   int32_t mInc{0};
+   int32_t mRate{1};
+   SmoothMode mMode{SmoothMode_Linear};
+};
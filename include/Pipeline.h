@@ -0,0 +1,96 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Signal chain policies for ErisSynth
+
+   A pipeline picks the sample format of the Gen -> VCF chain together
+   with the oscillator and filter working in that format, plus the few
+   block operations Eris does in between. The output block handed to
+   AREnv and to the Audio Library is always int16_t.
+
+   FixedPipeline  int16_t, GenDynFixed + VCFixed, no float at audio rate
+   FloatPipeline  float, GenDyn + VCFloat, one conversion at the output
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include "Arduino.h"
+#include "AudioStream.h"
+#include "utility/dspinst.h"
+#include "GenDynFixed.h"
+#include "VCFixed.h"
+#include "VCFloat.h"
+
+#define PIPE_Q15_SCALE 32767.f
+
+struct FixedPipeline
+{
+   typedef int16_t Sample;
+   typedef GenDynFixed Osc;
+   typedef VCFixed Filter;
+
+   static inline float ToUnit( Sample acValue ){ return acValue * (1.f/PIPE_Q15_SCALE); }
+
+   static void ToLfo( const Sample *apIn, Sample *apOut, int acScale, int acSamples ){
+      for ( int n=0; n < acSamples; ++n ) {
+         apOut[n] = signed_saturate_rshift( apIn[n] * acScale, 16, 0 );
+      }
+   }
+
+   static void Mix( Sample *apData, const Sample *apIn, int acSamples ){
+      for ( int n=0; n < acSamples; ++n ) {
+         apData[n] = signed_add_16_and_16( apData[n], apIn[n] );
+      }
+   }
+
+   static void RunFilter( Filter& aFilter, Sample *apIn, int16_t *apOut, const Sample *apCtl, int acCtlStep, int acSamples ){
+      aFilter.Process( apIn, apOut, apCtl, acSamples, acCtlStep );
+   }
+};
+
+struct FloatPipeline
+{
+   typedef float Sample;
+   typedef GenDyn Osc;
+   typedef VCFloat Filter;
+
+   static inline float ToUnit( Sample acValue ){ return acValue; }
+
+   // clipped to +-1 like the Q15 saturation of the fixed pipeline
+   static void ToLfo( const Sample *apIn, Sample *apOut, int acScale, int acSamples ){
+      const float vscale = (float)acScale;
+      for ( int n=0; n < acSamples; ++n ) {
+         const float v = apIn[n] * vscale;
+         apOut[n] = v > 1.f ? 1.f : ( v < -1.f ? -1.f : v );
+      }
+   }
+
+   static void Mix( Sample *apData, const Sample *apIn, int acSamples ){
+      for ( int n=0; n < acSamples; ++n ) {
+         apData[n] += apIn[n];
+      }
+   }
+
+   // filter in place, then the only float -> int16 conversion of the chain
+   static void RunFilter( Filter& aFilter, Sample *apIn, int16_t *apOut, const Sample *apCtl, int acCtlStep, int acSamples ){
+      aFilter.Process( apIn, apIn, apCtl, acSamples, acCtlStep );
+      for ( int n=0; n < acSamples; ++n ) {
+         apOut[n] = saturate16( (int32_t)( apIn[n] * PIPE_Q15_SCALE ) );
+      }
+   }
+};
@@ -0,0 +1,136 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Per-stage cycle count profiler for Eris::update()
+
+   Compiled in only when ERIS_PROFILE is defined. Each stage accumulates
+   the cycles spent in it during one update() (a stage can be entered
+   several times per block), then PROF_COMMIT() folds the per-block
+   totals into min/mean/max and a log2 histogram.
+
+   Counter: DWT cycle counter on the Cortex-M7, TSC on x86 hosts,
+   clock_gettime() nanoseconds on other hosts.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#if defined(ERIS_HOST)
+ #if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+ #else
+  #include <time.h>
+ #endif
+#endif
+
+#define PROF_HIST_BINS 16
+#define PROF_HIST_MIN_LOG2 6 // first bin collects everything below 2^6 cycles
+
+enum ProfStage
+{
+   ProfStage_Io=0,  // block allocation, scratch clearing, events, transmit
+   ProfStage_Gen2,
+   ProfStage_Gen1,
+   ProfStage_Conv,  // f2fix / fix2f and the Gen2 -> Lfo scaling
+   ProfStage_Gain,  // Gen1/Gen2 gain ramps
+   ProfStage_Mix,
+   ProfStage_Vcf,
+   ProfStage_Env,
+   ProfStage_Total, // whole update()
+
+   cNumProfStages
+};
+
+struct ProfStats
+{
+   uint32_t count;
+   uint32_t min;
+   uint32_t max;
+   uint64_t sum;
+   uint32_t hist[PROF_HIST_BINS];
+
+   float Mean() const { return count > 0 ? (float)sum / (float)count : 0.f; }
+};
+
+class Profiler
+{
+public:
+   static inline uint32_t Now(){
+#if defined(ERIS_HOST)
+ #if defined(__x86_64__) || defined(__i386__)
+      return (uint32_t)__rdtsc();
+ #else
+      struct timespec ts;
+      clock_gettime( CLOCK_MONOTONIC, &ts );
+      return (uint32_t)( (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec );
+ #endif
+#else
+      return ARM_DWT_CYCCNT;
+#endif
+   }
+
+   static inline void Add( ProfStage acStage, uint32_t acCycles ){
+      mBlock[acStage] += acCycles;
+   }
+
+   static inline void Start(){
+      mMark = mBlockStart = Now();
+   }
+
+   static inline void Mark( ProfStage acStage ){
+      const uint32_t vnow = Now();
+      mBlock[acStage] += vnow - mMark;
+      mMark = vnow;
+   }
+
+   static inline void End(){
+      mBlock[ProfStage_Total] += Now() - mBlockStart;
+      Commit();
+   }
+
+   // fold the cycles accumulated during the current block into the stats
+   static void Commit();
+   static void Reset();
+
+   static const ProfStats& Stats( ProfStage acStage ){ return mStats[acStage]; }
+   static const char* StageName( ProfStage acStage );
+
+   // one line per stage: name n min avg max | histogram
+   static void Dump( Print& aOut );
+
+private:
+   static uint32_t mBlock[cNumProfStages];
+   static ProfStats mStats[cNumProfStages];
+   static uint32_t mMark;
+   static uint32_t mBlockStart;
+};
+
+// PROF_START() opens a timed region, then each PROF_MARK(stage) charges
+// the cycles elapsed since the previous mark to that stage. The mark is
+// kept in the Profiler, so functions called from update() (the voices)
+// can place their own marks.
+#ifdef ERIS_PROFILE
+#define PROF_START() Profiler::Start()
+#define PROF_MARK(stage) Profiler::Mark(stage)
+#define PROF_COMMIT() Profiler::End()
+#else
+#define PROF_START() do {} while (0)
+#define PROF_MARK(stage) do {} while (0)
+#define PROF_COMMIT() do {} while (0)
+#endif
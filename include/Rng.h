@@ -0,0 +1,73 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Xorshift32 random generator (G. Marsaglia, "Xorshift RNGs", 2003)
+
+   Three shifts and three xors per number, no multiply, no floating point
+   until the final conversion. Each GenDyn owns one, so every oscillator
+   has its own reproducible sequence.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#define RNG_DEFAULT_SEED 0x2545F491u
+#define RNG_TO_UNIT (1.f / 16777216.f) // 2^-24
+
+class Rng
+{
+public:
+   Rng(){}
+
+   // the all-zero state is a fixed point, remap it
+   void Seed( uint32_t acSeed ){
+      mState = acSeed != 0 ? acSeed : RNG_DEFAULT_SEED;
+   }
+
+   inline uint32_t Next(){
+      uint32_t x = mState;
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      mState = x;
+      return x;
+   }
+
+   // uniform in [0,1)
+   inline float NextUnit(){
+      return (float)( Next() >> 8 ) * RNG_TO_UNIT;
+   }
+
+   // acCount uniform numbers in [0,1) in one pass
+   void Fill( float *apOut, int acCount ){
+      uint32_t x = mState;
+      for ( int i=0; i < acCount; ++i ) {
+         x ^= x << 13;
+         x ^= x >> 17;
+         x ^= x << 5;
+         apOut[i] = (float)( x >> 8 ) * RNG_TO_UNIT;
+      }
+      mState = x;
+   }
+
+   uint32_t State() const { return mState; }
+
+private:
+   uint32_t mState{RNG_DEFAULT_SEED};
+};
@@ -0,0 +1,68 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   The sample rate of the whole engine
+
+   ERIS_SAMPLE_RATE is the audio library's AUDIO_SAMPLE_RATE_EXACT, which on
+   the Teensy also sets the I2S clock. To change it, define that one macro:
+   -DAUDIO_SAMPLE_RATE_EXACT=48000.0f in the PlatformIO build_flags, or
+   configure the host build with cmake -DERIS_SAMPLE_RATE=48000.
+
+   The constants that are per sample rather than per second come from
+   gcRateTable, one row per supported rate, scaled from the values the
+   code was tuned with at 44117.6 Hz (the Teensy default). An unlisted
+   rate fails to compile: add its row.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "AudioStream.h"
+
+#define ERIS_SAMPLE_RATE ( (float)AUDIO_SAMPLE_RATE_EXACT )
+
+struct RateConsts
+{
+   float mRate;
+   float mDcCoef;        // GenDyn dc blocker, pole at ~0.7 Hz
+   float mDcCoefLfo;     // the same at the control rate, mDcCoef^LFO_DECIM
+   int32_t mDcCoefQ31;
+   int32_t mDcCoefLfoQ31;
+   float mKPNyquist;     // GenDyn keeps freq * control points below this
+   int32_t mVcfSmooth;   // Q16 per sample, ~5 ms
+   int32_t mGainRamp;    // Q16 per sample, ~150 ms from 0 to 1
+};
+
+static constexpr RateConsts gcRateTable[] = {
+   //  rate          dc            dc lfo        dc Q31      dc lfo Q31  kp nyquist  vcf  gain
+   {  44100.f,      0.99989996f,  0.99840056f,  2147268814, 2144048877, 19992.f,    300, 10 },
+   {  44117.64706f, 0.9999f,      0.9984012f,   2147268900, 2144050250, 20000.f,    300, 10 },
+   {  48000.f,      0.999908088f, 0.998530419f, 2147286268, 2144327747, 21760.f,    276,  9 },
+   {  88200.f,      0.999949979f, 0.99919996f,  2147376228, 2145765575, 39984.f,    150,  5 },
+   {  96000.f,      0.999954043f, 0.999264939f, 2147384956, 2145905117, 43520.f,    138,  5 },
+};
+static constexpr int cNumRates = sizeof(gcRateTable) / sizeof(gcRateTable[0]);
+
+constexpr int RateIndex( float acRate, int i = 0 ){
+   return i >= cNumRates ? -1 : ( gcRateTable[i].mRate == acRate ? i : RateIndex( acRate, i + 1 ) );
+}
+
+static_assert( RateIndex( ERIS_SAMPLE_RATE ) >= 0, "no row for this sample rate in gcRateTable" );
+
+// the row of ERIS_SAMPLE_RATE
+static constexpr RateConsts gcRate = gcRateTable[ RateIndex( ERIS_SAMPLE_RATE ) ];
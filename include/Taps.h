@@ -0,0 +1,85 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Per-module signal taps for regression tests
+
+   Compiled in only when ERIS_TAPS is defined (host test builds). Each
+   voice hands the output of its stages to the installed hook, scaled to
+   [-1,1] floats whatever the pipeline, so the fixed and float chains can
+   be compared stage by stage.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#define TAP_CHUNK 32
+
+enum TapPoint
+{
+   TapPoint_Gen2=0, // raw oscillator outputs, before the gain ramps
+   TapPoint_Gen1,
+   TapPoint_Vcf,
+   TapPoint_Env,    // what the voice adds to the mix
+
+   cNumTapPoints
+};
+
+typedef void (*TapHook)( void* apUser, TapPoint acPoint, int acVoice, const float* apData, int acSamples );
+
+class Taps
+{
+public:
+   static void SetHook( TapHook apHook, void* apUser ){
+      mpHook = apHook;
+      mpUser = apUser;
+   }
+
+   // the voice the next Record() calls belong to
+   static inline void Voice( int acVoice ){ mVoice = acVoice; }
+
+   static void Record( TapPoint acPoint, const float* apData, int acSamples ){
+      if ( mpHook ) mpHook( mpUser, acPoint, mVoice, apData, acSamples );
+   }
+
+   // Q15 samples, same scaling as FixedPipeline::ToUnit()
+   static void Record( TapPoint acPoint, const int16_t* apData, int acSamples ){
+      if ( !mpHook ) return;
+      float vbuf[TAP_CHUNK];
+      for ( int s=0; s < acSamples; s += TAP_CHUNK ) {
+         const int vn = acSamples - s < TAP_CHUNK ? acSamples - s : TAP_CHUNK;
+         for ( int n=0; n < vn; ++n ) vbuf[n] = apData[s+n] * (1.f/32767.f);
+         mpHook( mpUser, acPoint, mVoice, vbuf, vn );
+      }
+   }
+
+   static const char* PointName( TapPoint acPoint );
+
+private:
+   static TapHook mpHook;
+   static void* mpUser;
+   static int mVoice;
+};
+
+#ifdef ERIS_TAPS
+#define TAP_VOICE(v) Taps::Voice(v)
+#define TAP(point, data, n) Taps::Record(point, data, n)
+#else
+#define TAP_VOICE(v) do {} while (0)
+#define TAP(point, data, n) do {} while (0)
+#endif
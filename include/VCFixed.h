@@ -39,6 +39,11 @@
 
 #include <Arduino.h>    
 #include "AudioStream.h"
+#include "ParamSmoother.h"
+#include "FilterMode.h"
+#include "SampleRate.h"
+
+#define VCF_SMOOTH_COEF gcRate.mVcfSmooth // ~5ms to settle on a new cutoff/resonance
 
 class VCFixed
 {
@@ -47,21 +52,41 @@ public:
 		SetCutoff(1000);
 		octaveControl(1.0); // default values
 		SetResonance(0.707);
+		mFcenter.SetExp(VCF_SMOOTH_COEF);
+		mDamp.SetExp(VCF_SMOOTH_COEF);
+		mFcenter.Reset(setting_fcenter);
+		mDamp.Reset(setting_damp);
 		state_inputprev = 0;
 		state_lowpass = 0;
 		state_bandpass = 0;
+		ResetCorner();
 	}
 
-    void Process(const int16_t *in,  int16_t *out, const int16_t *ctl,  const int acsamples );
+	// ctl may be NULL (no modulation). A control that only moves every
+	// acctlstep samples (e.g. a control rate LFO) is read once per step
+	// and the corner ramped in between.
+    void Process(const int16_t *in,  int16_t *out, const int16_t *ctl,  const int acsamples, const int acctlstep = 1 );
+
+	// only the outputs the mode needs are summed and saturated
+	void SetMode(FilterMode mode) { mode_ = mode; }
+	void SetMorph(float pos) {
+		float lp, bp, hp;
+		FilterMorph(pos, lp, bp, hp);
+		// in double: 1.0f * 2147483647.0f rounds up to 2^31 and wraps
+		morph_lp = lp * 2147483647.0;
+		morph_bp = bp * 2147483647.0;
+		morph_hp = hp * 2147483647.0;
+	}
 	
 	void SetCutoff(float freq) {
 		if (freq < 20.0f) freq = 20.0f;
-		else if (freq > AUDIO_SAMPLE_RATE_EXACT/2.5f) freq = AUDIO_SAMPLE_RATE_EXACT/2.5f;
-		setting_fcenter = (freq * (3.141592654f/(AUDIO_SAMPLE_RATE_EXACT*2.0f)))
+		else if (freq > ERIS_SAMPLE_RATE/2.5f) freq = ERIS_SAMPLE_RATE/2.5f;
+		setting_fcenter = (freq * (3.141592654f/(ERIS_SAMPLE_RATE*2.0f)))
 			* 2147483647.0f;
+		mFcenter.SetTarget(setting_fcenter);
 		// TODO: should we use an approximation when freq is not a const,
 		// so the sinf() function isn't linked?
-		setting_fmult = sinf(freq * (3.141592654f/(AUDIO_SAMPLE_RATE_EXACT*2.0f)))
+		setting_fmult = sinf(freq * (3.141592654f/(ERIS_SAMPLE_RATE*2.0f)))
 			* 2147483647.0f;
 	}
 	void SetResonance(float q) {
@@ -69,6 +94,7 @@ public:
 		else if (q > 5.0f) q = 5.0f;
 		// TODO: allow lower Q when frequency is lower
 		setting_damp = (1.0f / q) * 1073741824.0f;
+		mDamp.SetTarget(setting_damp);
 	}
 	void octaveControl(float n) {
 		// filter's corner frequency is Fcenter * 2^(control * N)
@@ -80,6 +106,14 @@ public:
 	}
 	
 private:
+	template <FilterMode mode>
+	void Run(const int16_t *in, int16_t *out, const int16_t *ctl, const int acsamples, const int acctlstep);
+	void ResetCorner();
+
+	FilterMode mode_{FilterMode_LowPass};
+	int32_t morph_lp{2147483647}; // Q31 weights of the Morph mode
+	int32_t morph_bp{0};
+	int32_t morph_hp{0};
 	int32_t setting_fcenter;
 	int32_t setting_fmult;
 	int32_t setting_octavemult;
@@ -87,4 +121,7 @@ private:
 	int32_t state_inputprev;
 	int32_t state_lowpass;
 	int32_t state_bandpass;
+	int32_t state_fmult{0}; // last corner, the start of the next ramp
+	ParamSmoother mFcenter; // setting_fcenter and setting_damp, ramped per block
+	ParamSmoother mDamp;
 };
@@ -7,6 +7,10 @@
   A floating point version of the implementation by Paul Stoffregen, see:
   https://github.com/PaulStoffregen/Audio
 
+  The corner uses FastExp2/FastSin (FastMath.h) instead of powf/sinf.
+ 
+  */
+
 /* Audio Library for Teensy 3.X
  * Copyright (c) 2014, Paul Stoffregen, paul@pjrc.com
  *
@@ -37,9 +41,9 @@
 
 #include "Arduino.h"
 #include "AudioStream.h"
+#include "FilterMode.h"
+#include "SampleRate.h"
 
-#define CUTOFF_MIN 40.f
-#define CUTOFF_MAX 8000.f
 
 class VCFloat
 {
@@ -53,11 +57,12 @@ public:
     state_inputprev = 0;
     state_lowpass = 0;
     state_bandpass = 0;
+    ResetCorner();
   }
   
   void SetCutoff( float freq ) 
   {
-    mCutoffRadians = freq * 3.141592654f / AUDIO_SAMPLE_RATE_EXACT;
+    mCutoffRadians = freq * 3.141592654f / ERIS_SAMPLE_RATE;
   }
   
   void SetResonance( float q ) 
@@ -78,21 +83,46 @@ public:
     mOctavemult = acValue;
   }
   
-  void Process( float *apIn, float *apOut, float *apCtl );
+  // the output is a weighted sum of lp, bp and hp, cheap enough in float
+  // to serve every mode
+  void SetMode( FilterMode acMode )
+  {
+    mMode = acMode;
+    UpdateWeights();
+  }
+
+  void SetMorph( float acPos )
+  {
+    mMorph = acPos;
+    UpdateWeights();
+  }
+
+  // same as VCFixed::Process, in and out may be the same buffer
+  void Process( const float *apIn, float *apOut, const float *apCtl, const int acsamples, const int acCtlStep = 1 );
   
 private:
+
+  void UpdateWeights();
+  void ResetCorner();
+  float ControlToFmult( float acCutoff, float acOctavemult, float acControl );
   
-  // params
-  volatile float mCutoffRadians; // in radians, 0...pi/2
-  volatile float mOctavemult;
-  volatile float mDamp;
+  // params, read once per Process()
+  float mCutoffRadians; // in radians, 0...pi/2
+  float mOctavemult;
+  float mDamp;
+  float mWeightLp{1.f};
+  float mWeightBp{0.f};
+  float mWeightHp{0.f};
+  FilterMode mMode{FilterMode_LowPass};
+  float mMorph{0.f};
 
   // internals
 
   float state_inputprev;
   float state_lowpass;
   float state_bandpass;
-  float mRadiansMin{ CUTOFF_MIN * 3.141592654f / AUDIO_SAMPLE_RATE_EXACT}; 
-  float mRadiansMax{ CUTOFF_MAX * 3.141592654f / AUDIO_SAMPLE_RATE_EXACT}; 
+  float mLastFmult{0.f};
+  float mRadiansMin{ CUTOFF_MIN * 3.141592654f / ERIS_SAMPLE_RATE}; 
+  float mRadiansMax{ CUTOFF_MAX * 3.141592654f / ERIS_SAMPLE_RATE}; 
   
 };
@@ -19,17 +19,29 @@
 
 #include "AREnv.h"
 
-void AREnv::Process ( audio_block_t *apOut, int acSamples ) {
+void AREnv::Process ( int16_t *apData, int acSamples ) {
 
-    int16_t* vpIn = apOut->data;
+    int16_t* vpIn = apData;
+    const int32_t vpeakreq = mParams.Front().mPeak;
+    int32_t vcurpeak = mCurPeak;
+    const int32_t vstep = mStep;
+
+    // bias ramp for this block
+    mBias.NextBlock( acSamples );
+    int32_t vbias = mBias.Start();
+    const int32_t vbiasinc = mBias.Inc();
 
     switch (mState)
     {
       case EnvState_Off:
       {
-        for ( int n=0; n < AUDIO_BLOCK_SAMPLES; ++n ) {
-          UpdateGain();
-          int32_t vgain = min(mCurBias,65536);
+        if ( vbiasinc == 0 ) {
+          MulC( vpIn, min(vbias,65536), acSamples );
+          break;
+        }
+        for ( int n=0; n < acSamples; ++n ) {
+          vbias += vbiasinc;
+          int32_t vgain = min(vbias,65536);
           vpIn[n] = ( vgain * vpIn[n] ) >> 16;
         }
       }
@@ -37,13 +49,13 @@ void AREnv::Process ( audio_block_t *apOut, int acSamples ) {
 
       case EnvState_Attack:
       {
-        for ( int n=0; n < AUDIO_BLOCK_SAMPLES; ++n ) {
-          UpdateGain();
-          int32_t vgain = min( mCurBias + mCurPeak, 65536 );
+        for ( int n=0; n < acSamples; ++n ) {
+          vbias += vbiasinc;
+          int32_t vgain = min( vbias + vcurpeak, 65536 );
           vpIn[n] = ( vgain * vpIn[n] ) >> 16;
-          mCurPeak += mStep;
-          mCurPeak = min(mCurPeak, 65536);
-          if ( ( mStep>0 && mCurPeak>=mPeak_req) || ( mStep<0 && mCurPeak<=mPeak_req) ) {
+          vcurpeak += vstep;
+          vcurpeak = min(vcurpeak, 65536);
+          if ( ( vstep>0 && vcurpeak>=vpeakreq) || ( vstep<0 && vcurpeak<=vpeakreq) ) {
               mState = EnvState_Hold;
           }
         }
@@ -52,9 +64,13 @@ void AREnv::Process ( audio_block_t *apOut, int acSamples ) {
   
       case EnvState_Hold:
       {
-        for ( int n=0; n < AUDIO_BLOCK_SAMPLES; ++n ) {
-          UpdateGain();
-          int32_t vgain = min(mCurBias + mCurPeak, 65536);
+        if ( vbiasinc == 0 ) {
+          MulC( vpIn, min(vbias + vcurpeak, 65536), acSamples );
+          break;
+        }
+        for ( int n=0; n < acSamples; ++n ) {
+          vbias += vbiasinc;
+          int32_t vgain = min(vbias + vcurpeak, 65536);
           vpIn[n] = ( vgain * vpIn[n] ) >> 16;
         }
       }
@@ -62,46 +78,34 @@ void AREnv::Process ( audio_block_t *apOut, int acSamples ) {
   
       case EnvState_Release:  
       {
-        for ( int n=0; n < AUDIO_BLOCK_SAMPLES; ++n ) {
-          UpdateGain();
-          int32_t vgain = min(mCurBias + mCurPeak, 65536);
+        for ( int n=0; n < acSamples; ++n ) {
+          vbias += vbiasinc;
+          int32_t vgain = min(vbias + vcurpeak, 65536);
           vpIn[n] = ( vgain * vpIn[n] ) >> 16;
-          mCurPeak += mStep;
-          mCurPeak = max(mCurPeak,0);
-          if ( mCurPeak <= 0 ) {
+          vcurpeak += vstep;
+          vcurpeak = max(vcurpeak,0);
+          if ( vcurpeak <= 0 ) {
             mState = EnvState_Off;
           } 
         }
       }
         break;
     }
+
+    mCurPeak = vcurpeak;
 }
 
 void AREnv::TriggerAttack(){
-    mAttack = mAttack_req;
-    int32_t vdelta = mPeak_req - mCurPeak;
+    const Params& p = mParams.Front();
+    mAttack = p.mAttack;
+    int32_t vdelta = p.mPeak - mCurPeak;
     mStep = vdelta / mAttack;
     mState = EnvState_Attack;
-    Serial.println("TriggerAttack");
-    Serial.println(mStep);
   }
 
 void AREnv::TriggerRelease(){
-  mRelease = mRelease_req;
+  mRelease = mParams.Front().mRelease;
   int32_t vdelta = mCurPeak;
   mStep = -vdelta / mRelease;
   mState = EnvState_Release;
-  Serial.println("TriggerRelease: step = ");
-  Serial.println(mStep);
 }
-
-void AREnv::UpdateGain(){
-  if ( mCurBias < mBias_req ){
-        mCurBias += GAIN_STEP_PER_SAMPLE;
-        if ( mCurBias > mBias_req )  mCurBias = mBias_req; 
-      }
-      else if ( mCurBias > mBias_req ){
-        mCurBias -= GAIN_STEP_PER_SAMPLE;
-        if ( mCurBias < mBias_req )  mCurBias = mBias_req; 
-      }
-}
\ No newline at end of file
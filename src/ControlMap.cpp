@@ -0,0 +1,92 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Knob response curves, deadband and change detection
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#include <math.h>
+#include "ControlMap.h"
+
+ControlMap::ControlMap()
+{
+    for ( int k=0; k < CONTROL_MAX_KNOBS; ++k ) {
+        Setup( k, ControlCurve_Linear, 0.f, 1.f );
+    }
+}
+
+void ControlMap::Setup( int acKnob, ControlCurve acCurve, float acMin, float acMax, int acDeadband )
+{
+    if ( acKnob < 0 || acKnob >= CONTROL_MAX_KNOBS ) return;
+
+    float* t = mTable[acKnob];
+    for ( int i=0; i <= CONTROL_TABLE_SIZE; ++i ) {
+        const float x = (float)i / CONTROL_TABLE_SIZE;
+        float y;
+        switch ( acCurve )
+        {
+            case ControlCurve_Square:
+                y = acMin + ( acMax - acMin ) * x * x;
+                break;
+            case ControlCurve_Exp:
+                y = acMin * powf( acMax / acMin, x );
+                break;
+            default:
+                y = acMin + ( acMax - acMin ) * x;
+                break;
+        }
+        t[i] = y;
+    }
+    mDeadband[acKnob] = (int16_t)acDeadband;
+    mRaw[acKnob] = -1;
+    mValue[acKnob] = t[0];
+}
+
+void ControlMap::Invalidate()
+{
+    for ( int k=0; k < CONTROL_MAX_KNOBS; ++k ) mRaw[k] = -1;
+}
+
+bool ControlMap::Update( int acKnob, uint16_t acRaw )
+{
+    if ( acRaw > CONTROL_RAW_MAX ) acRaw = CONTROL_RAW_MAX;
+
+    const int vlast = mRaw[acKnob];
+    if ( vlast == acRaw ) return false;
+    if ( vlast >= 0 ) {
+        int vdelta = acRaw - vlast;
+        if ( vdelta < 0 ) vdelta = -vdelta;
+        // the ends are always reachable, whatever the deadband
+        const bool vend = acRaw == 0 || acRaw == CONTROL_RAW_MAX;
+        if ( vdelta <= mDeadband[acKnob] && !vend ) return false;
+    }
+
+    mRaw[acKnob] = acRaw;
+    mValue[acKnob] = Lookup( acKnob, acRaw );
+    return true;
+}
+
+float ControlMap::Lookup( int acKnob, uint16_t acRaw )
+{
+    // table position in 8 fractional bits
+    const uint32_t vpos = ( (uint32_t)acRaw * ( CONTROL_TABLE_SIZE << 8 ) ) / CONTROL_RAW_MAX;
+    const uint32_t vidx = vpos >> 8;
+    const float* t = mTable[acKnob];
+    if ( vidx >= CONTROL_TABLE_SIZE ) return t[CONTROL_TABLE_SIZE];
+    const float vfrac = ( vpos & 0xFF ) * ( 1.f / 256.f );
+    return t[vidx] + ( t[vidx+1] - t[vidx] ) * vfrac;
+}
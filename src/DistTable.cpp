@@ -0,0 +1,125 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Distributions for the GenDyn random walk
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#include "DistTable.h"
+
+#define HYPERBCOS_LOGARGMIN 0.0005f // was 0.001
+
+DistConsts DistTable::Prepare( DistId acDist, float acParam )
+{
+    DistConsts c;
+    c.dist = acDist;
+    c.param = acParam;
+    c.k0 = 0.f;
+    c.k1 = 0.f;
+
+    switch (acDist) 
+    {
+        case Cauchy:
+        {
+            float argmax = 1.5f;
+            float argmin = 0.7f; //0.75f;
+            float scale = acParam*(argmax-argmin) + argmin;
+            c.k0 = scale;
+            c.k1 = 1.f / tanf(scale); // normfactor
+        }
+        break;
+
+        case Hyperbcos: 
+        {
+            // stretch param1 towards 1 using a log
+            // [0,1] --> [-3,3]
+            // exp(-3) = 0.0498
+            // exp(3) = 20.0855
+            float p1 = (logf( acParam * 20.0357f + 0.0498f ) + 3.f) * 0.1667f;
+            float argmax = 1.4f * p1; // was 1.5
+            c.k0 = argmax;
+            c.k1 = (1.f-HYPERBCOS_LOGARGMIN) / tanf(argmax);
+        }
+        break;
+
+        case Exponential:
+        {
+            c.k0 = 0.999f * acParam;
+            c.k1 = 1.f / logf( 1.f - c.k0 );
+        }
+        break;
+
+        default:
+            break;
+    }
+
+    return c;
+}
+
+float DistTable::Eval( const DistConsts& acConsts, float acRand, float acLfo )
+{
+    switch (acConsts.dist) 
+    {
+        case Linear:
+        {
+            // FIXME: using param1 here biases the dist,
+            // replace with something like?
+            // float vval = acParam1*(2.f * (acParam2) - 1.f);
+            return 2.f * (acConsts.param*acRand) - 1.f;
+        }
+
+        case Cauchy:
+        {
+            float arg = ( 2.f*acRand - 1.f ) * acConsts.k0;
+            return tanf( arg ) * acConsts.k1;
+        }
+
+        case Hyperbcos: 
+        {
+            float arg = acRand * acConsts.k0;
+            float vval = logf( tanf(arg) * acConsts.k1 + HYPERBCOS_LOGARGMIN );
+            return vval * ( 1.f / logf(HYPERBCOS_LOGARGMIN) );
+        }
+
+        case Exponential:
+        {
+            // X original -(log(1-z))/a  [0,1]-> [1,0]-> [0,-inf]->[0,inf]
+            float vval = logf( 1.f - ( acRand * acConsts.k0 ) ) * acConsts.k1;
+            return 2.f * vval - 1.f;
+        }
+
+        case Lfo:
+            return 2.f * (acConsts.param*acLfo) - 1.f;
+        
+        default:
+            return 0.f;
+    }
+}
+
+void DistTable::Build( DistId acDist, float acParam )
+{
+    if ( acDist == mDist && acParam == mParam ) return;
+
+    mDist = acDist;
+    mParam = acParam;
+    if ( acDist == Linear || acDist == Lfo ) return; // no table needed
+
+    DistConsts c = Prepare( acDist, acParam );
+    for ( int i=0; i <= DIST_TABLE_SIZE; ++i ) {
+        mTable[i] = Eval( c, (float)i / DIST_TABLE_SIZE, 0.f );
+    }
+}
@@ -20,13 +20,15 @@
 #include <Arduino.h>
 #include "Eris.h"
 
-Eris::Eris() : AudioStream( 0, NULL ){
-   mGen1.SetSamplerate(SR_DEF);
+//-------------------------------------------------------------------
+// ErisVoice
+
+template <class Pipeline>
+ErisVoice<Pipeline>::ErisVoice(){
    mGen2.SetFreqRange(0);
    mGen1.SetFreqNorm(0.25f);
    mGen1.SetScale(0.5f);
    mGen1.SetParam(0.5f);
-   mGen2.SetSamplerate(SR_DEF);
    mGen2.SetFreqRange(0);
    mGen2.SetFreqNorm(0.5f);
    mGen2.SetParam(1.f);
@@ -38,159 +40,519 @@ Eris::Eris() : AudioStream( 0, NULL ){
    mAREnv.SetGain(1.f);
    mAREnv.SetAttackMs(100.f);
    mAREnv.SetReleaseMs(200.f);
+   mGen1Gain.SetLinear(GAIN_RAMP_STEP);
+   mGen2Gain.SetLinear(GAIN_RAMP_STEP);
+}
+
+template <class Pipeline>
+void ErisVoice<Pipeline>::Process( int16_t *apOut, int acSamples ){
+
+   // word aligned for the packed 16 bit kernels
+   Sample blockGen1[AUDIO_BLOCK_SAMPLES] __attribute__ ((aligned (4)));
+   Sample blockGen2[AUDIO_BLOCK_SAMPLES] __attribute__ ((aligned (4)));
+   Sample blockLfo[AUDIO_BLOCK_SAMPLES] __attribute__ ((aligned (4)));
+
+   const VoiceShared sh = *mpShared;
+
+   // LO range: Gen2 is an LFO, control rate is plenty
+   if ( sh.mGen2Range ) mGen2.ProcessLfo( blockGen2, acSamples );
+   else mGen2.Process( blockGen2, NULL, 0.f, acSamples );
+   PROF_MARK(ProfStage_Gen2);
+   TAP( TapPoint_Gen2, blockGen2, acSamples );
+
+   // save a value for controlling LEDs
+   float vgen2val = Pipeline::ToUnit( blockGen2[0] );
+   mLastGen2Val = vgen2val * vgen2val;
+
+   // Update Gen2 Gain
+   mGen2Gain.SetTarget( sh.mGen2Gain_req );
+   mGen2Gain.Apply( blockGen2, acSamples );
+   PROF_MARK(ProfStage_Gain);
+
+   // Gen2 --> Lfo, scaled up
+   Pipeline::ToLfo( blockGen2, blockLfo, LFO_SCALE, acSamples );
+   PROF_MARK(ProfStage_Conv);
+
+   // Modulate Gen1 Rate with Lfo
+   float vRateMod = (float)sh.mRateMod;
+   mGen1.Process( blockGen1, blockLfo, vRateMod, acSamples );
+   PROF_MARK(ProfStage_Gen1);
+   TAP( TapPoint_Gen1, blockGen1, acSamples );
+
+   float vgen1val = Pipeline::ToUnit( blockGen1[0] );
+   mLastGen1Val = vgen1val * vgen1val;
+
+   // Gen1 Gain @ sr
+   mGen1Gain.SetTarget( sh.mGen1Gain_req );
+   mGen1Gain.Apply( blockGen1, acSamples );
+   PROF_MARK(ProfStage_Gain);
+   
+   if (sh.mGen2ToOut){
+      Pipeline::Mix( blockGen1, blockGen2, acSamples );
+   }
+   PROF_MARK(ProfStage_Mix);
+
+   // Process Filter, the Lfo only moves every LFO_DECIM samples in the LO range
+   Pipeline::RunFilter( mVcf, blockGen1, apOut, blockLfo, sh.mGen2Range ? LFO_DECIM : 1, acSamples );
+   PROF_MARK(ProfStage_Vcf);
+   TAP( TapPoint_Vcf, apOut, acSamples );
+
+   // Process AR
+   mAREnv.Process( apOut, acSamples );
+   if (mAREnv.Done()) {
+      mMidiFreq_req=0;
+      mNote=VOICE_NO_NOTE;
+   }
+   PROF_MARK(ProfStage_Env);
+   TAP( TapPoint_Env, apOut, acSamples );
+}
+
+// Nothing is rendered while the voice is silent, the oscillators and the
+// filter just pause and pick up where they were on the next note or bias
+// change. The gains can't be heard meanwhile, so they jump to their targets
+// instead of ramping after the wake-up; the envelope fades the voice in.
+template <class Pipeline>
+void ErisVoice<Pipeline>::Park(){
+   mGen1Gain.Reset( mpShared->mGen1Gain_req );
+   mGen2Gain.Reset( mpShared->mGen2Gain_req );
+   mLastGen1Val = 0.f;
+   mLastGen2Val = 0.f;
+}
+
+template <class Pipeline>
+void ErisVoice<Pipeline>::NoteOn( byte acNote, byte acVel, uint32_t acStamp ){
+   mNote = acNote;
+   mStamp = acStamp;
+   mMidiFreq_req = gcNoteFreqs[acNote];
+   mGen1.SetFreq(mMidiFreq_req);
+
+   // control gen2 only if @audiorate
+   if ( mpShared->mGen2Range==0 ){
+      SetGen2Partial();
+   }  
+   mAREnv.SetGain( (float)acVel * DIV127 );
+   mAREnv.TriggerAttack();
+}
+
+template <class Pipeline>
+void ErisVoice<Pipeline>::NoteOff(){
+   mAREnv.TriggerRelease();
+}
+
+template <class Pipeline>
+void ErisVoice<Pipeline>::UpdateGen1Rate(){
+   // if midi note active, bypass
+   if (mMidiFreq_req == 0){
+      mGen1.SetFreqNorm(mpShared->mGen1Rate_req);
+   }
+   // if midi note active and gen2 is @ audiorate, or sync is on, gen2 rate controls the harmonic #
+   if ( mpShared->mSyncGens==true || ( mMidiFreq_req>0 && mpShared->mGen2Range==0 )){
+      SetGen2Partial();
+   }      
+}
+
+template <class Pipeline>
+void ErisVoice<Pipeline>::UpdateGen2Rate(){
+   // if midi note active and gen2 is @ audiorate, or sync is on, gen2 rate controls the harmonic #
+   if ( mpShared->mSyncGens==true || ( mMidiFreq_req>0 && mpShared->mGen2Range==0 )){
+      SetGen2Partial();
+   }
+   else{
+      mGen2.SetFreqNorm( mpShared->mGen2Rate_req );
+   }
+}
+
+template <class Pipeline>
+void ErisVoice<Pipeline>::SetGen2Partial(){
+   int ind = (int)round( mpShared->mGen2Rate_req * (NPARTIALRATIOS-1) );
+   float vpartialRatio = gcPartialsRatios[ind];
+   float vval = Clip( vpartialRatio * mGen1.Freq(), FREQ_MIN, FREQ_MAX );
+   mGen2.SetFreq( vval );
+}
+
+//-------------------------------------------------------------------
+// ErisSynth
+
+template <class Pipeline>
+ErisSynth<Pipeline>::ErisSynth() : AudioStream( 0, NULL ){
+   for ( int v=0; v < ERIS_MAX_VOICES; ++v ) {
+      mVoices[v].Bind( &mShared );
+      mVoices[v].mGen1.ShareDist( mVoices[0].mGen1 );
+      mVoices[v].mGen2.ShareDist( mVoices[0].mGen2 );
+   }
+   for ( int p=0; p < cNumErisParams; ++p ) {
+      mPosted[p] = 0.f;
+      mPostedValid[p] = false;
+      mPostedDirty[p] = false;
+   }
    msine.set_freq(400);
 }
 
- void Eris::update(void){
+template <class Pipeline>
+void ErisSynth<Pipeline>::update(void){
 
-   float blockGen1[AUDIO_BLOCK_SAMPLES];
-   int16_t blockGen1t[AUDIO_BLOCK_SAMPLES];
-   float blockGen2[AUDIO_BLOCK_SAMPLES];
-   int16_t blockGen2t[AUDIO_BLOCK_SAMPLES];
-   float blockLfo[AUDIO_BLOCK_SAMPLES];
-   int16_t blockLfot[AUDIO_BLOCK_SAMPLES];
+   PROF_START();
 
    audio_block_t *blockout;
    blockout = allocate();
    if (!blockout) return; 
 
-   memset(blockGen1, 0, AUDIO_BLOCK_SAMPLES * sizeof(float));
-   memset(blockGen2, 0, AUDIO_BLOCK_SAMPLES * sizeof(float));
-   memset(blockGen1t, 0, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
-   memset(blockGen2t, 0, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
-   memset(blockLfot, 0, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
-   memset(blockLfo, 0, AUDIO_BLOCK_SAMPLES * sizeof(float));
+   const uint32_t vblockstart = mSampleTime;
+   mBlockMicros = micros();
 
-   // test
-   //msine.Process(blockGen1, AUDIO_BLOCK_SAMPLES);
+   int32_t blockSum[AUDIO_BLOCK_SAMPLES];
+   memset( blockSum, 0, sizeof(blockSum) );
+   PROF_MARK(ProfStage_Io);
 
-   mGen2.Process( blockGen2, blockGen2, 0.f, AUDIO_BLOCK_SAMPLES );   
-         
-   f2fix(blockGen2, blockGen2t, AUDIO_BLOCK_SAMPLES);
+   // sort the new events in after the pending ones with the same time
+   ErisEvent ev;
+   while ( mNumPending < EVENT_PENDING_SIZE && mEvents.Peek( ev ) ) {
+      mEvents.Pop();
+      const int32_t voffset = (int32_t)( ev.mTime - vblockstart );
+      int i = mNumPending++;
+      for ( ; i > 0 && (int32_t)( mPending[i-1].mTime - vblockstart ) > voffset; --i ) {
+         mPending[i] = mPending[i-1];
+      }
+      mPending[i] = ev;
+   }
 
-   // Update Gen2 Gain
-   int16_t *op2 = (int16_t*)blockGen2t; 
-   const int16_t* oend2 = (int16_t*)(blockGen2t + AUDIO_BLOCK_SAMPLES);
-   do {
-         if ( mGen2Gain < mGen2Gain_req ){
-            mGen2Gain += GAIN_RAMP_STEP;
-            if ( mGen2Gain > mGen2Gain_req )  mGen2Gain = mGen2Gain_req; 
-         }
-         else if ( mGen2Gain > mGen2Gain_req ){
-            mGen2Gain -= GAIN_RAMP_STEP;
-            if ( mGen2Gain < mGen2Gain_req )  mGen2Gain = mGen2Gain_req; 
+   // render up to the next event, apply it, go on
+   int vpos = 0;
+   int vnext = 0;
+   int vrendered = 0;
+   while ( vpos < AUDIO_BLOCK_SAMPLES ) {
+      int vend = AUDIO_BLOCK_SAMPLES;
+      while ( vnext < mNumPending ) {
+         const int32_t voffset = (int32_t)( mPending[vnext].mTime - vblockstart );
+         if ( voffset > vpos ) {
+            if ( voffset < AUDIO_BLOCK_SAMPLES ) vend = voffset;
+            break;
          }
-        int16_t tmp = *op2;
-        *op2++ = ( mGen2Gain * tmp ) >> 16;
-   } while (op2 < oend2);
+         ApplyEvent( mPending[vnext++] ); // late events land here
+      }
+      PROF_MARK(ProfStage_Io);
 
-   // Gen2 --> Lfo
-   for ( int n=0; n < AUDIO_BLOCK_SAMPLES; ++n ) {
-      float val =  (float)blockGen2t[n] * Q_DIV_16;
-      //val = 0.5 * val + 0.5; 
-      blockLfo[n] = val * 3.0; // scale up 
+      vrendered += RenderVoices( blockSum + vpos, vend - vpos );
+      vpos = vend;
    }
 
-   // Modulate Gen1 Rate with Lfo
-   float vRateMod = (float)mRateMod;
-   mGen1.Process( blockGen1, blockLfo, vRateMod, AUDIO_BLOCK_SAMPLES );
-   f2fix(blockGen1, blockGen1t, AUDIO_BLOCK_SAMPLES);
-
-   // Gen1 Gain @ sr
-   int16_t *op1 = (int16_t*)blockGen1t; 
-   const int16_t* oend1 = (int16_t*)(blockGen1t + AUDIO_BLOCK_SAMPLES);
-   do {
-         if ( mGen1Gain < mGen1Gain_req ){
-            mGen1Gain += GAIN_RAMP_STEP;
-            if ( mGen1Gain > mGen1Gain_req )  mGen1Gain = mGen1Gain_req; 
-         }
-         else if ( mGen1Gain > mGen1Gain_req ){
-            mGen1Gain -= GAIN_RAMP_STEP;
-            if ( mGen1Gain < mGen1Gain_req )  mGen1Gain = mGen1Gain_req; 
-         }
-        int16_t tmp = *op1;
-        *op1++ = ( mGen1Gain * tmp ) >> 16;
-   } while (op1 < oend1);
-   
-   // save a value for controlling LEDs
-   mLastGen1Val = blockGen1[0] * blockGen1[0];
-   mLastGen2Val = blockGen2[0] * blockGen2[0];
-   
-   if (mGen2ToOut){
-      for ( int n=0; n < AUDIO_BLOCK_SAMPLES; ++n ) {
-         int16_t vmix = signed_add_16_and_16(blockGen1t[n],blockGen2t[n]);
-         blockGen1t[n] = vmix;
-      }
+   // the later ones wait for their block
+   if ( vnext > 0 ) {
+      mNumPending -= vnext;
+      memmove( mPending, mPending + vnext, mNumPending * sizeof(ErisEvent) );
    }
 
-   // temp
-   f2fix(blockLfo, blockLfot, AUDIO_BLOCK_SAMPLES);
+   mSampleTime = vblockstart + AUDIO_BLOCK_SAMPLES;
 
-   // Process Filter 
-   mVcf.Process( blockGen1t, blockout->data, blockLfot, AUDIO_BLOCK_SAMPLES );
+   // all the voices silent: transmit nothing, the outputs read it as silence
+   if ( vrendered == 0 ) {
+      release( blockout );
+      PROF_MARK(ProfStage_Io);
+      PROF_COMMIT();
+      return;
+   }
 
-   // Process AR
-   mAREnv.Process( blockout, AUDIO_BLOCK_SAMPLES );
-   if (mAREnv.Done()) mMidiFreq_req=0;
+   // sum * 1/sqrt(voices), Q12 (unity for one voice)
+   const int32_t vgain = mMixGain;
+   int16_t* out = blockout->data;
+   for ( int n=0; n < AUDIO_BLOCK_SAMPLES; ++n ) {
+      out[n] = saturate16( ( blockSum[n] * vgain ) >> 12 );
+   }
+   PROF_MARK(ProfStage_Mix);
 
    // (double mono for now)
    transmit( blockout,0 );
    transmit( blockout,1 );   
    release( blockout );
+   PROF_MARK(ProfStage_Io);
+   PROF_COMMIT();
  }
 
-void Eris::TriggerMidiNote( byte acNote, byte acVel ){
-      __disable_irq();
-      mMidiFreq_req = gcNoteFreqs[acNote];
-      mGen1.SetFreq(mMidiFreq_req);
-      
-      // control gen2 only if @audiorate
-      if ( mGen2Range==0 ){
-         int ind = (int)round( mGen2Rate_req * (NPARTIALRATIOS-1) );
-         float vpartialRatio = gcPartialsRatios[ind];
-         float vval = Clip( vpartialRatio * mGen1.Freq(), FREQ_MIN, FREQ_MAX );
-         mGen2.SetFreq( vval );
-      }  
-      mAREnv.SetGain( (float)acVel * DIV127 );
-      mAREnv.TriggerAttack();
-      __enable_irq();
-    }
-
-void Eris::TriggerRelease(){
-      __disable_irq();
-      mAREnv.TriggerRelease();
-      __enable_irq();
-   }
-
-void Eris::SetGen1Rate( float acValue ){
-   __disable_irq();
-   // if midi note active, bypass
-   if (mMidiFreq_req == 0){
-      mGen1Rate_req = acValue;
-      mGen1.SetFreqNorm(mGen1Rate_req);
+// adds acSamples of every active voice to apSum, returns how many
+// voices were rendered (silent ones are skipped)
+template <class Pipeline>
+int ErisSynth<Pipeline>::RenderVoices( int32_t *apSum, int acSamples ){
+
+   // the voices always start on an aligned buffer, whatever the offset
+   int16_t blockVoice[AUDIO_BLOCK_SAMPLES] __attribute__ ((aligned (4)));
+   const int vnumvoices = mNumVoices;
+   float vgen1val = 0.f;
+   float vgen2val = 0.f;
+   int vrendered = 0;
+
+   for ( int v=0; v < vnumvoices; ++v ) {
+      ErisVoice<Pipeline>& voice = mVoices[v];
+      if ( voice.Silent() ) {
+         voice.Park();
+         continue;
+      }
+      TAP_VOICE( v );
+      voice.Process( blockVoice, acSamples );
+      vrendered++;
+      for ( int n=0; n < acSamples; ++n ) apSum[n] += blockVoice[n];
+      vgen1val = max( vgen1val, voice.mLastGen1Val );
+      vgen2val = max( vgen2val, voice.mLastGen2Val );
+      PROF_MARK(ProfStage_Mix);
    }
-   // if midi note active and gen2 is @ audiorate, or sync is on, gen2 rate controls the harmonic #
-   if ( mSyncGens==true || ( mMidiFreq_req>0 && mGen2Range==0 )){
-      int ind = (int)round( mGen2Rate_req * (NPARTIALRATIOS-1) );
-      float vpartialRatio = gcPartialsRatios[ind];
-      float vval = Clip( vpartialRatio * mGen1.Freq(), FREQ_MIN, FREQ_MAX );
-      mGen2.SetFreq( vval );
-   }      
-   __enable_irq();
+   mLastGen1Val = vgen1val;
+   mLastGen2Val = vgen2val;
+   return vrendered;
 }
 
-void Eris::SetGen2Rate( float acValue ){      
-   __disable_irq();
-   mGen2Rate_req = acValue;
-   // if midi note active and gen2 is @ audiorate, or sync is on, gen2 rate controls the harmonic #
-   if ( mSyncGens==true || ( mMidiFreq_req>0 && mGen2Range==0 )){
-      int ind = (int)round( mGen2Rate_req * (NPARTIALRATIOS-1) );
-      float vpartialRatio = gcPartialsRatios[ind];
-      float vval = Clip( vpartialRatio * mGen1.Freq(), FREQ_MIN, FREQ_MAX );
-      mGen2.SetFreq( vval );
+template <class Pipeline>
+uint32_t ErisSynth<Pipeline>::Clock(){
+   // a block boundary between the reads changes mSampleTime, retry
+   uint32_t vstart, vmicros;
+   do {
+      vstart = mSampleTime;
+      vmicros = mBlockMicros;
+   } while ( vstart != mSampleTime );
+
+   // mSampleTime is already the start of the next block
+   uint32_t velapsed = (uint32_t)( ( micros() - vmicros ) * ( ERIS_SAMPLE_RATE * 1e-6f ) );
+   if ( velapsed > AUDIO_BLOCK_SAMPLES - 1 ) velapsed = AUDIO_BLOCK_SAMPLES - 1;
+   return vstart + velapsed;
+}
+
+template <class Pipeline>
+void ErisSynth<Pipeline>::PostEvent( EventType acType, byte acId, byte acVel, float acValue, uint32_t acTime ){
+   ErisEvent ev;
+   ev.mTime = acTime;
+   ev.mType = acType;
+   ev.mId = acId;
+   ev.mVel = acVel;
+   ev.mValue = acValue;
+   mEvents.Push( ev ); // full: dropped, 128 events is far more than a block ever sees
+}
+
+// knobs are rescanned every loop, only changes are queued. A change that
+// finds the queue full stays dirty until FlushParams() gets it through
+template <class Pipeline>
+void ErisSynth<Pipeline>::PostParam( ErisParam acParam, float acValue ){
+   if ( mPostedValid[acParam] && mPosted[acParam] == acValue && !mPostedDirty[acParam] ) return;
+
+   mPosted[acParam] = acValue;
+   mPostedValid[acParam] = true;
+   mPostedDirty[acParam] = !PushParam( acParam, acValue );
+}
+
+template <class Pipeline>
+void ErisSynth<Pipeline>::FlushParams(){
+   for ( int p=0; p < cNumErisParams; ++p ) {
+      if ( !mPostedDirty[p] ) continue;
+      if ( !PushParam( (ErisParam)p, mPosted[p] ) ) return; // still full
+      mPostedDirty[p] = false;
    }
-   else{
-      mGen2.SetFreqNorm( mGen2Rate_req );
+}
+
+template <class Pipeline>
+bool ErisSynth<Pipeline>::PushParam( ErisParam acParam, float acValue ){
+   ErisEvent ev;
+   ev.mTime = mSampleTime; // next block start
+   ev.mType = EventType_Param;
+   ev.mId = acParam;
+   ev.mVel = 0;
+   ev.mValue = acValue;
+   return mEvents.Push( ev );
+}
+
+template <class Pipeline>
+void ErisSynth<Pipeline>::ApplyEvent( const ErisEvent& acEvent ){
+   switch ( acEvent.mType )
+   {
+      case EventType_Param:
+         ApplyParam( (ErisParam)acEvent.mId, acEvent.mValue );
+         break;
+
+      case EventType_NoteOn:
+      {
+         int v = AllocVoice( acEvent.mId );
+         mVoices[v].NoteOn( acEvent.mId, acEvent.mVel, ++mNoteStamp );
+         break;
+      }
+
+      case EventType_NoteOff:
+         for ( int v=0; v < mNumVoices; ++v ) {
+            ErisVoice<Pipeline>& voice = mVoices[v];
+            if ( voice.Note() == acEvent.mId && !voice.Idle() && !voice.Releasing() ) {
+               voice.NoteOff();
+            }
+         }
+         break;
+
+      case EventType_MonoNoteOn:
+         mVoices[0].NoteOn( acEvent.mId, acEvent.mVel, ++mNoteStamp );
+         break;
+
+      case EventType_MonoRelease:
+         mVoices[0].NoteOff();
+         break;
+
+      case EventType_Seed:
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) {
+            mVoices[v].mGen1.Seed( ( acEvent.mSeed * 2 + 1 ) ^ ( v * 0x9E3779B9u ) );
+            mVoices[v].mGen2.Seed( ( acEvent.mSeed * 2 + 2 ) ^ ( v * 0x9E3779B9u ) );
+         }
+         break;
+
+      default:
+         break;
    }
-   __enable_irq();
-}
\ No newline at end of file
+}
+
+template <class Pipeline>
+void ErisSynth<Pipeline>::ApplyParam( ErisParam acParam, float acValue ){
+   switch ( acParam )
+   {
+      case ErisParam_Gen1Rate:
+         mShared.mGen1Rate_req = acValue;
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) mVoices[v].UpdateGen1Rate();
+         break;
+
+      case ErisParam_Gen1Scale:
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) mVoices[v].mGen1.SetScale(acValue);
+         break;
+
+      case ErisParam_Gen1DurScale:
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) mVoices[v].mGen1.SetDurScale(acValue);
+         break;
+
+      case ErisParam_Gen1Gain:
+         mShared.mGen1Gain_req = (int32_t)( acValue * Q_SCALER_32 );
+         break;
+
+      case ErisParam_Gen2Gain:
+         mShared.mGen2Gain_req = (int32_t)( acValue * Q_SCALER_32 );
+         break;
+
+      case ErisParam_Gen2Rate:
+         mShared.mGen2Rate_req = acValue;
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) mVoices[v].UpdateGen2Rate();
+         break;
+
+      case ErisParam_Gen2Scale:
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) mVoices[v].mGen2.SetScale(acValue);
+         break;
+
+      case ErisParam_Gen2DurScale:
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) mVoices[v].mGen2.SetDurScale(acValue);
+         break;
+
+      case ErisParam_Gen2ToOut:
+         mShared.mGen2ToOut = acValue != 0.f;
+         break;
+
+      case ErisParam_Gen2Range:
+         mShared.mGen2Range = acValue != 0.f;
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) mVoices[v].mGen2.SetFreqRange( mShared.mGen2Range );
+         break;
+
+      case ErisParam_SyncGens:
+         mShared.mSyncGens = acValue != 0.f;
+         break;
+
+      case ErisParam_RateMod:
+         mShared.mRateMod = acValue != 0.f;
+         break;
+
+      case ErisParam_GainMod:
+         mGainMod = acValue != 0.f;
+         break;
+
+      case ErisParam_Cutoff:
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) mVoices[v].mVcf.SetCutoff( acValue );
+         break;
+
+      case ErisParam_Resonance:
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) mVoices[v].mVcf.SetResonance( acValue );
+         break;
+
+      case ErisParam_CutoffMod:
+         mCutMod = acValue != 0.f;
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) {
+            mVoices[v].mVcf.octaveControl( mCutMod ? VCF_OCTAVERANGE : 0.f );
+         }
+         break;
+
+      case ErisParam_FilterMode:
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) mVoices[v].mVcf.SetMode( (FilterMode)(int)acValue );
+         break;
+
+      case ErisParam_FilterMorph:
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) mVoices[v].mVcf.SetMorph( acValue );
+         break;
+
+      case ErisParam_Attack:
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) mVoices[v].mAREnv.SetAttackMs(acValue);
+         break;
+
+      case ErisParam_Release:
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) mVoices[v].mAREnv.SetReleaseMs(acValue);
+         break;
+
+      case ErisParam_BiasGain:
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) mVoices[v].mAREnv.SetBiasGain(acValue);
+         break;
+
+      case ErisParam_NumVoices:
+      {
+         int vnum = (int)acValue;
+         vnum = vnum < 1 ? 1 : ( vnum > ERIS_MAX_VOICES ? ERIS_MAX_VOICES : vnum );
+         // voices left out stop where they are, release them for when they come back
+         for ( int v=vnum; v < mNumVoices; ++v ) {
+            if ( !mVoices[v].Idle() ) mVoices[v].NoteOff();
+         }
+         mNumVoices = vnum;
+         mMixGain = (int32_t)( 4096.f / sqrtf( (float)vnum ) + 0.5f );
+         break;
+      }
+
+      case ErisParam_VoiceSteal:
+         mVoiceSteal = (VoiceSteal)(int)acValue;
+         break;
+
+      case ErisParam_Oversample:
+         for ( int v=0; v < ERIS_MAX_VOICES; ++v ) {
+            mVoices[v].mGen1.SetOversample( (int)acValue );
+            mVoices[v].mGen2.SetOversample( (int)acValue );
+         }
+         break;
+
+      default:
+         break;
+   }
+}
+
+// same key retriggers its voice, then a free voice, 
+// else steal one, released voices first
+template <class Pipeline>
+int ErisSynth<Pipeline>::AllocVoice( byte acNote ){
+   const int vnumvoices = mNumVoices;
+
+   for ( int v=0; v < vnumvoices; ++v ) {
+      if ( mVoices[v].Note() == acNote && !mVoices[v].Idle() ) return v;
+   }
+   for ( int v=0; v < vnumvoices; ++v ) {
+      if ( mVoices[v].Idle() ) return v;
+   }
+
+   int vbest = 0;
+   for ( int v=1; v < vnumvoices; ++v ) {
+      ErisVoice<Pipeline>& cand = mVoices[v];
+      ErisVoice<Pipeline>& best = mVoices[vbest];
+      if ( cand.Releasing() != best.Releasing() ) {
+         if ( cand.Releasing() ) vbest = v;
+         continue;
+      }
+      bool vbetter = mVoiceSteal == VoiceSteal_Quietest ? 
+                     cand.Level() < best.Level() :
+                     (int32_t)( cand.Stamp() - best.Stamp() ) < 0;
+      if ( vbetter ) vbest = v;
+   }
+   return vbest;
+}
+
+template class ErisVoice<FixedPipeline>;
+template class ErisVoice<FloatPipeline>;
+template class ErisSynth<FixedPipeline>;
+template class ErisSynth<FloatPipeline>;
@@ -8,8 +8,10 @@
     the Supercollider version by Nick Collins, see:
     https://github.com/supercollider/supercollider/blob/develop/server/plugins/GendynUGens.cpp
 
-    + in this version, only the amplitudes are modulated by the stochastic 
-    process, not the durations.
+    + the amplitudes and the durations of the segments follow two random
+    walks, each with its own distribution. The duration walk moves the
+    step of each segment within +-DurRange octaves of the set frequency.
+    At DurScale 0 the segments keep the same length.
 
     + The 5 distributions are interpolated by mean of the "Dist" parameter
 
@@ -30,13 +32,28 @@
 
 #include "GenDyn.h"
 
-void GenDyn::Init(const float *apSeeds)
+void GenDyn::Init(const float *apSeeds, uint32_t acStream)
 {
+    // FNV-1a over the seed values
+    uint32_t vhash = 2166136261u ^ ( acStream * 0x9E3779B9u );
+    if ( apSeeds ) {
+        for ( int i=0; i < NUM_CONTROL_PTS_MAX; ++i ) {
+            uint32_t vbits;
+            memcpy( &vbits, &apSeeds[i], sizeof(vbits) );
+            for ( int b=0; b < 4; ++b ) {
+                vhash ^= ( vbits >> (8*b) ) & 0xFF;
+                vhash *= 16777619u;
+            }
+        }
+    }
+    Seed( vhash );
+
     // freq range is [FREQ_MIN FREQ_MAX] thus mdx range is 
-    float vNumKPMin = (int)floorf(0.25f / mFreqMax * mSR);
-    float vNumKPMax = (int)floorf(0.25f / mFreqMin * mSR);
-    mdxmin = mFreqMin / mSR * vNumKPMax;
-    mdxmax = mFreqMax / mSR * vNumKPMin;
+    const Params& p = mParams.Front();
+    float vNumKPMin = (int)floorf(0.25f / p.mFreqMax * p.mSR);
+    float vNumKPMax = (int)floorf(0.25f / p.mFreqMin * p.mSR);
+    mdxmin = p.mFreqMin / p.mSR * vNumKPMax;
+    mdxmax = p.mFreqMax / p.mSR * vNumKPMin;
     mNumKP = 10;
 
     // init the state according to current knobs positions
@@ -44,153 +61,301 @@ void GenDyn::Init(const float *apSeeds)
     {
         mY[i] = 0.f; //2.f * apSeeds[i] - 1.f;
         mdY[i] = 0.f; //2.f * apSeeds[i] - 1.f;
+        mDurY[i] = 0.f;
     }
+    mDurMul = 1.f;
+}
+
+void GenDyn::Seed( uint32_t acSeed )
+{
+    mRng.Seed( acSeed );
+    mRandPos = RAND_BLOCK_SIZE; // drop what was drawn with the old seed
 }
 
 void GenDyn::Process ( float *apOut, float *apCtl, float acFMAmount, int acSamples )
+{
+    mBlock = mParams.Front();
+    bool vrestart;
+    const int vos = BeginOversample( vrestart );
+    if ( vos == 1 )
+    {
+        Render( apOut, apCtl, acFMAmount, acSamples );
+        return;
+    }
+    if ( vrestart )
+    {
+        mDecim2.Reset();
+        mDecim4.Reset();
+    }
+
+    // render vos times the samples, ctl held, then decimate by 2 (or 2x2)
+    float vbuf[OVERSAMPLE_CHUNK * OVERSAMPLE_MAX];
+    float vctl[OVERSAMPLE_CHUNK * OVERSAMPLE_MAX];
+    while ( acSamples > 0 )
+    {
+        const int vn = acSamples < OVERSAMPLE_CHUNK ? acSamples : OVERSAMPLE_CHUNK;
+        if ( apCtl )
+        {
+            float* vdst = vctl;
+            for ( int i=0; i < vn; ++i )
+                for ( int k=0; k < vos; ++k ) *vdst++ = apCtl[i];
+            apCtl += vn;
+        }
+        Render( vbuf, apCtl ? vctl : NULL, acFMAmount, vn * vos );
+        if ( vos == 4 ) mDecim4.Process( vbuf, vbuf, 2 * vn );
+        mDecim2.Process( vbuf, apOut, vn );
+        apOut += vn;
+        acSamples -= vn;
+    }
+}
+
+int GenDyn::BeginOversample( bool& aRestart )
+{
+    const int vos = mBlock.mFreqRange > 0 ? 1 : mBlock.mOversample;
+    aRestart = vos != mOversampleRun;
+    mOversampleRun = vos;
+    if ( vos > 1 ) mBlock.mInvSR *= 1.f / vos;
+    mBlock.mOversample = vos;
+    return vos;
+}
+
+void GenDyn::Render ( float *apOut, const float *apCtl, float acFMAmount, int acSamples )
 {      
     float* out = apOut;
-    float* ctl = apCtl;
+    const float* ctl = apCtl;
     int n = acSamples;
 
-    while (n--)
+    float x = mx;
+    float vprevval = mPrevVal;
+    float vprevout = mPrevOut;
+
+    if ( acFMAmount == 0.f || !ctl )
     {
-        if ( mx >= 1.f ) 
+        // fixed rate: the step is constant over a segment, so we know
+        // how many samples are left before the next breakpoint
+        UpdateNumKP( mBlock.mFreq );
+        const float vdxset = mdx;
+        float vdx = SegmentDx( vdxset );
+        float vinvdx = 1.f / vdx;
+
+        while ( n > 0 )
         {
-            mx -= 1.f;
-            mIndex = ++mIndex % mNumKP;
-
-            float vrand = fabs( fmod( ( my0 * cLehmerCoef1 ) + cLehmerCoef2, 1.f ) );
-            
-            // y0,y1 = prev k-points values
-            // y2 = target point value
-            my0 = my1;
-            my1 = my2;
-         
-            float vdy = mdY[mIndex] + ComputeInterpDist( vrand, *ctl );
-            vdy = mirroring( vdy, 1.f );
-            mdY[mIndex] = vdy;
-
-            // update current point
-            my2 = mY[mIndex] + ( mScale * vdy );
-            my2 = mirroring( my2, 0.6f );
-            mY[mIndex] = my2;
+            if ( x >= 1.f ) 
+            {
+                x -= 1.f;
+                NewSegment( ctl ? *ctl : 0.f );
+                vdx = SegmentDx( vdxset );
+                vinvdx = 1.f / vdx;
+            }
+
+            // samples with x < 1 in the current segment
+            int vrun = (int)( ( 1.f - x ) * vinvdx ) + 1;
+            if ( vrun > n ) vrun = n;
+            n -= vrun;
+            if ( ctl ) ctl += vrun;
+
+            const float c0 = mC0;
+            const float c1 = mC1;
+            const float c2 = mC2;
+            while ( vrun-- )
+            {
+                // interp btw prev point and current(target) point
+                float val = c0 + x * ( c1 + x * c2 );
+                x += vdx;
+
+                // dc blocking filter
+                float vout = val - vprevval + DC_COEF * vprevout;
+                vprevout = vout;
+                vprevval = val; 
+                *out++ = vout;
+            }
         }
-
-        // interp btw prev point and current(target) point
-        float val = LagrangeInterp( mx, my0, my1, my2 );
-
-        // FM with ctl signal 
-        float vfrange = min(FREQ_MAX-mFreq, mFreq-FREQ_MIN);
-        float vf = mFreq + acFMAmount * vfrange * (*ctl);
-
-        // mod numKP with freq in order to achieve higher freq range
-        // vf*KP must be < nyquist, thus KP < 20KHz / vf
-        mNumKP = (int)floorf( 20000.f / vf );
-        if (mNumKP > NUM_CONTROL_PTS_MAX ) mNumKP = NUM_CONTROL_PTS_MAX;
-        if (mNumKP < NUM_CONTROL_PTS_MIN ) mNumKP = NUM_CONTROL_PTS_MIN;
-        mdx = vf / mSR * mNumKP;
-        if (mdx >= 0.99f) mdx = 0.99f;
-        mx += mdx;
-    
-         // dc blocking filter
-        // R=0.995; % for 44100 SR
-        float vout = val - mPrevVal + 0.9999f * mPrevOut;
-        mPrevOut = vout;
-        mPrevVal = val; 
-        *out++ = vout;
-
-        ctl++;
     }
-}
+    else
+    {
+        // FM with ctl signal: the step changes every sample, 
+        // the number of control points and the duration only at the breakpoints
+        const float vfreq = mBlock.mFreq;
+        const float vinvsr = mBlock.mInvSR;
+        const float vfrange = min(FREQ_MAX-vfreq, vfreq-FREQ_MIN);
+        const float vfmdepth = acFMAmount * vfrange;
+        float vkpsr = mNumKP * vinvsr * mDurMul;
+
+        while ( n-- )
+        {
+            const float vf = vfreq + vfmdepth * (*ctl);
 
-float GenDyn::ComputeInterpDist( float acParam2, float acLfo ) {
-    // compute Dist1
-    float d1 = ComputeDist(mDist1,mParam,acParam2,acLfo);
+            if ( x >= 1.f ) 
+            {
+                x -= 1.f;
+                UpdateNumKP( vf );
+                NewSegment( *ctl );
+                vkpsr = mNumKP * vinvsr * mDurMul;
+            }
 
-    // compute Dist2
-    float d2 = ComputeDist(mDist2,mParam,acParam2,acLfo);
+            float val = mC0 + x * ( mC1 + x * mC2 );
 
-    // interp btw the two
-    float vd = d1 + (d2-d1) * mDistParam;
+            float vdx = vf * vkpsr;
+            if (vdx >= 0.99f) vdx = 0.99f;
+            x += vdx;
 
-    return vd;
+            float vout = val - vprevval + DC_COEF * vprevout;
+            vprevout = vout;
+            vprevval = val; 
+            *out++ = vout;
+
+            ctl++;
+        }
+    }
+
+    mx = x;
+    mPrevVal = vprevval;
+    mPrevOut = FlushTiny( vprevout ); // a constant walk decays it into the denormals
 }
 
-float GenDyn::ComputeDist(  DistId acDist, 
-                            float acParam1,   
-                            float acParam2, 
-                            float acLfo ) 
+void GenDyn::ProcessLfo ( float *apOut, int acSamples )
 {
-    switch (acDist) 
+    float* out = apOut;
+    int n = acSamples;
+
+    mBlock = mParams.Front();
+    mBlock.mOversample = 1;
+    mOversampleRun = 1; // the decimators restart on the next oversampled block
+    UpdateNumKP( mBlock.mFreq );
+    float vdxset = mdx * LFO_DECIM;
+    if ( vdxset >= 0.99f ) vdxset = 0.99f;
+    float vdx = SegmentDx( vdxset );
+
+    float vcur = mLfoCur;
+    const float vinvdecim = 1.f / LFO_DECIM;
+
+    while ( n > 0 )
     {
-        case Linear:
+        if ( mLfoCount == 0 )
         {
-            // FIXME: using param1 here biases the dist,
-            // replace with something like?
-            // float vval = acParam1*(2.f * (acParam2) - 1.f);
-            float vval = 2.f * (acParam1*acParam2) - 1.f;
-            return vval;
+            // one step of the walk at the control rate
+            if ( mx >= 1.f )
+            {
+                mx -= 1.f;
+                NewSegment( 0.f );
+                vdx = SegmentDx( vdxset );
+            }
+            float val = mC0 + mx * ( mC1 + mx * mC2 );
+            mx += vdx;
+
+            float vout = val - mPrevVal + LFO_DC_COEF * mPrevOut;
+            mPrevOut = FlushTiny( vout );
+            mPrevVal = val;
+
+            // ramp from the previous step, no drift across steps
+            vcur = mLfoNext;
+            mLfoNext = vout;
+            mLfoInc = ( vout - vcur ) * vinvdecim;
+            mLfoCount = LFO_DECIM;
         }
-        break;
 
-        case Cauchy:
+        int vrun = mLfoCount < n ? mLfoCount : n;
+        n -= vrun;
+        mLfoCount -= vrun;
+        const float vinc = mLfoInc;
+        while ( vrun-- )
         {
-            float argmax = 1.5f;
-            float argmin = 0.7f; //0.75f;
-            float scale = acParam1*(argmax-argmin) + argmin;
-            float arg = ( 2.f*acParam2 - 1.f ) *  scale;
-            float vval = tanf( arg );
-            float normfactor = tanf(scale);
-            vval = vval / normfactor;
-
-            return vval;
+            vcur += vinc;
+            *out++ = vcur;
         }
-        break;
+    }
 
-        case Hyperbcos: 
-        {
-            // stretch param1 towards 1 using a log
-            // [0,1] --> [-3,3]
-            // exp(-3) = 0.0498
-            // exp(3) = 20.0855
-            float p1 = (logf( acParam1 * 20.0357f + 0.0498f ) + 3.f) * 0.1667f;
-            float argmax = 1.4 * p1; // was 1.5
-            float arg = acParam2 * argmax;
-            float logargmin = 0.0005f; // was 0.001
-            float vval = logf( tanf(arg) / tanf(argmax) * (1.f-logargmin) + logargmin );
-            float normfact = 1.f / logf(logargmin);
-            vval = vval * normfact;
-            
-            return vval;
-        }
-        break;
+    mLfoCur = vcur;
+}
 
-        case Exponential:
-        {
-            // X original -(log(1-z))/a  [0,1]-> [1,0]-> [0,-inf]->[0,inf]
-            float c = logf( 1.f - ( 0.999f * acParam1 ) );
-            float vval = logf( 1.f - ( acParam2 * 0.999f * acParam1) ) / c;
-            
-            return 2.f * vval - 1.f;
-        }
-        break;
+// stochastic update of the next control point, once per segment
+void GenDyn::NewSegment( float acCtl )
+{
+    mIndex = ( mIndex + 1 ) % mNumKP;
 
-        case Lfo:
-        {
-            float vval = acParam1 * acLfo;
-            vval = 2.f * vval - 1.f;
-            
-            return vval;
-        }
-        break;
-        
-        default:
-            return 0.f;
-            break;
+    float vrand = NextRandom();
+
+    // y0,y1 = prev k-points values
+    // y2 = target point value
+    my0 = my1;
+    my1 = my2;
+
+    float vdy = mdY[mIndex] + ComputeInterpDist( vrand, acCtl );
+    vdy = mirroring( vdy, 1.f );
+    mdY[mIndex] = vdy;
+
+    // update current point
+    my2 = mY[mIndex] + ( mBlock.mScale * vdy );
+    my2 = mirroring( my2, 0.6f );
+    mY[mIndex] = my2;
+
+    // LagrangeInterp() expanded as c0 + c1*x + c2*x^2
+    mC0 = my0;
+    mC1 = -1.5f * my0 + 2.f * my1 - 0.5f * my2;
+    mC2 = 0.5f * my0 - my1 + 0.5f * my2;
+
+    // duration of this segment, as a multiplier of the step. At scale 0
+    // no random number is drawn and the walk settles back to the set freq
+    if ( mBlock.mDurScale > 0.f )
+    {
+        float vdur = mDurY[mIndex] + mBlock.mDurScale * InterpDist( mpDistOwner->mDurDistSet.Front(), NextRandom(), acCtl );
+        vdur = mirroring( vdur, 1.f );
+        mDurY[mIndex] = vdur;
+        mDurMul = FastExp2( vdur * mBlock.mDurRange );
+    }
+    else
+    {
+        mDurY[mIndex] = 0.f;
+        mDurMul = 1.f;
     }
+}
+
+// mod numKP with freq in order to achieve higher freq range
+// vf*KP must be < nyquist, thus KP < 20KHz / vf (at 44.1k, times the oversampling)
+void GenDyn::UpdateNumKP( float acFreq )
+{
+    mNumKP = (int)floorf( gcRate.mKPNyquist * mBlock.mOversample / acFreq );
+    if (mNumKP > NUM_CONTROL_PTS_MAX ) mNumKP = NUM_CONTROL_PTS_MAX;
+    if (mNumKP < NUM_CONTROL_PTS_MIN ) mNumKP = NUM_CONTROL_PTS_MIN;
+    mdx = acFreq * mNumKP * mBlock.mInvSR;
+    if (mdx >= 0.99f) mdx = 0.99f;
+}
+
+float GenDyn::ComputeInterpDist( float acParam2, float acLfo ) {
+    return InterpDist( mpDistOwner->mDistSet.Front(), acParam2, acLfo );
+}
+
+float GenDyn::InterpDist( const DistSet& ds, float acParam2, float acLfo ) {
+    // at the ends of the interp range only one dist is needed
+    if ( ds.mMix <= 0.f ) return ds.mTable1.Lookup( acParam2, acLfo );
+    if ( ds.mMix >= 1.f ) return ds.mTable2.Lookup( acParam2, acLfo );
+
+    float d1 = ds.mTable1.Lookup( acParam2, acLfo );
+    float d2 = ds.mTable2.Lookup( acParam2, acLfo );
 
-    return 0.f;
+    // interp btw the two
+    float vd = d1 + (d2-d1) * ds.mMix;
+
+    return vd;
+}
+
+// build the tables for the current dist pair and param, then swap them in
+void GenDyn::PublishDist()
+{
+    DistSet& back = mDistSet.Edit(); // Build() skips the tables still valid
+    back.mTable1.Build( mDist1, mParam );
+    back.mTable2.Build( mDist2, mParam );
+    back.mMix = mDistParam;
+    mDistSet.Publish();
+}
+
+void GenDyn::PublishDurDist()
+{
+    DistSet& back = mDurDistSet.Edit();
+    back.mTable1.Build( mDurDist1, mParam );
+    back.mTable2.Build( mDurDist2, mParam );
+    back.mMix = mDurDistParam;
+    mDurDistSet.Publish();
 }
 
 // mirroring for bounds - new vers
@@ -217,43 +382,91 @@ float GenDyn::ComputeDist(  DistId acDist,
     return in;   
 }
 
-void GenDyn::SetDist( float acValue )
+// Dist knob -> the pair of dists around it and the mix between them
+void GenDyn::SplitDist( float acValue, DistId& aDist1, DistId& aDist2, float& aMix )
 {
     if ( acValue < 0.f ) acValue = 0.f;
     else if ( acValue > DIST_PARAM_THRES_4 ) acValue = DIST_PARAM_THRES_4;
 
     if ( acValue <= DIST_PARAM_THRES_1)
     {
-        mDist1 = Linear;
-        mDist2 = Exponential;
-        mDistParam = acValue/DIST_PARAM_RANGE;
+        aDist1 = Linear;
+        aDist2 = Exponential;
+        aMix = acValue/DIST_PARAM_RANGE;
     }    
     else if ( acValue > DIST_PARAM_THRES_1 && acValue <= DIST_PARAM_THRES_2)
     {
-        mDist1 = Exponential;
-        mDist2 = Cauchy;
-        mDistParam = ( acValue - DIST_PARAM_THRES_1 ) / DIST_PARAM_RANGE;
+        aDist1 = Exponential;
+        aDist2 = Cauchy;
+        aMix = ( acValue - DIST_PARAM_THRES_1 ) / DIST_PARAM_RANGE;
     }
     else if ( acValue > DIST_PARAM_THRES_2 && acValue <= DIST_PARAM_THRES_3)
     {
-        mDist1 = Cauchy;
-        mDist2 = Hyperbcos;
-        mDistParam = ( acValue - DIST_PARAM_THRES_2 ) / DIST_PARAM_RANGE;
+        aDist1 = Cauchy;
+        aDist2 = Hyperbcos;
+        aMix = ( acValue - DIST_PARAM_THRES_2 ) / DIST_PARAM_RANGE;
     }
-    else if ( acValue > DIST_PARAM_THRES_3 && acValue <= DIST_PARAM_THRES_4)
+    else
     {
-        mDist1 = Hyperbcos;
-        mDist2 = Lfo;
-        mDistParam = ( acValue - DIST_PARAM_THRES_3 ) / DIST_PARAM_RANGE;
+        aDist1 = Hyperbcos;
+        aDist2 = Lfo;
+        aMix = ( acValue - DIST_PARAM_THRES_3 ) / DIST_PARAM_RANGE;
     }
 }
+
+void GenDyn::SetDist( float acValue )
+{
+    DistId vdist1, vdist2;
+    float vdistparam;
+    SplitDist( acValue, vdist1, vdist2, vdistparam );
+
+    if ( vdist1 == mDist1 && vdist2 == mDist2 && vdistparam == mDistParam ) return;
+
+    mDist1 = vdist1;
+    mDist2 = vdist2;
+    mDistParam = vdistparam;
+    PublishDist();
+}
+
+void GenDyn::SetDurDist( float acValue )
+{
+    DistId vdist1, vdist2;
+    float vdistparam;
+    SplitDist( acValue, vdist1, vdist2, vdistparam );
+
+    if ( vdist1 == mDurDist1 && vdist2 == mDurDist2 && vdistparam == mDurDistParam ) return;
+
+    mDurDist1 = vdist1;
+    mDurDist2 = vdist2;
+    mDurDistParam = vdistparam;
+    PublishDurDist();
+}
+
+void GenDyn::SetDurScale( float acValue )
+{
+    float a = acValue;
+    if( a > DUR_SCALE_MAX ) a = DUR_SCALE_MAX;
+    if( a < 0.f ) a = 0.f;
+    mParams.Edit().mDurScale = a;
+    mParams.Publish();
+}
+
+void GenDyn::SetDurRange( float acValue )
+{
+    float a = acValue;
+    if( a > DUR_RANGE_MAX ) a = DUR_RANGE_MAX;
+    if( a < 0.f ) a = 0.f;
+    mParams.Edit().mDurRange = a;
+    mParams.Publish();
+}
  
 void GenDyn::SetScale( float acValue )
 {
     float a = acValue;
     if( a > SCALE_MAX ) a = SCALE_MAX;
     if( a < SCALE_MIN ) a = SCALE_MIN;  
-    mScale = a;
+    mParams.Edit().mScale = a;
+    mParams.Publish();
 }
 
 void GenDyn::SetParam( float acValue )
@@ -261,35 +474,42 @@ void GenDyn::SetParam( float acValue )
     float a = acValue;
     if( a > PARAM_MAX ) a = PARAM_MAX;       
     if( a < PARAM_MIN ) a = PARAM_MIN; 
+    if ( fabsf( a - mParam ) < PARAM_EPS ) return;
     mParam = a;
+    PublishDist();
+    PublishDurDist();
 }
 
-void GenDyn::SetSamplerate( float acValue )
+void GenDyn::SetOversample( int acValue )
 {
-    mSR = acValue;
-    mdx = mFreq / mSR * mNumKP;
-    mdxmin = mFreqMin / mSR * mNumKP;
-    mdxmax = mFreqMax / mSR * mNumKP;
+    mParams.Edit().mOversample = acValue >= 4 ? 4 : ( acValue >= 2 ? 2 : 1 );
+    mParams.Publish();
 }
 
 // note: overwritten if you then call SetRange()
 void GenDyn::SetFreq( float acValue ){
-    mFreq = Clip(acValue,mFreqMin,mFreqMax);
-    mFreqNorm = (mFreq - mFreqMin) / (mFreqMax-mFreqMin);
+    Params& p = mParams.Edit();
+    p.mFreq = Clip(acValue,p.mFreqMin,p.mFreqMax);
+    p.mFreqNorm = (p.mFreq - p.mFreqMin) / (p.mFreqMax-p.mFreqMin);
+    mParams.Publish();
 }
 
 void GenDyn::SetFreqNorm( float acValue ){
-    mFreqNorm = Clip(acValue,0.f,1.f);
-    mFreq = mFreqMin + acValue * (mFreqMax-mFreqMin);
+    Params& p = mParams.Edit();
+    p.mFreqNorm = Clip(acValue,0.f,1.f);
+    p.mFreq = p.mFreqMin + acValue * (p.mFreqMax-p.mFreqMin);
+    mParams.Publish();
 }
 
 void GenDyn::SetFreqRange(int acRange){
-    mFreqRange = acRange;
-    mFreqMin = mFreqRange > 0 ? LFO_FREQ_MIN : FREQ_MIN;
-    mFreqMax = mFreqRange > 0 ? LFO_FREQ_MAX : FREQ_MAX;
-    mdxmin = mFreqMin / mSR * mNumKP;
-    mdxmax = mFreqMax / mSR * mNumKP;
-    mFreq = mFreqMin + mFreqNorm * (mFreqMax-mFreqMin);
+    Params& p = mParams.Edit();
+    p.mFreqRange = acRange;
+    p.mFreqMin = p.mFreqRange > 0 ? LFO_FREQ_MIN : FREQ_MIN;
+    p.mFreqMax = p.mFreqRange > 0 ? LFO_FREQ_MAX : FREQ_MAX;
+    mdxmin = p.mFreqMin / p.mSR * mNumKP;
+    mdxmax = p.mFreqMax / p.mSR * mNumKP;
+    p.mFreq = p.mFreqMin + p.mFreqNorm * (p.mFreqMax-p.mFreqMin);
+    mParams.Publish();
 }
 
 // 3pts interpolator
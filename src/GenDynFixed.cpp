@@ -0,0 +1,200 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   GenDyn Oscillator, fixed point rendering
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#include "GenDynFixed.h"
+
+void GenDynFixed::Process ( int16_t *apOut, const int16_t *apCtl, float acFMAmount, int acSamples )
+{
+    mBlock = mParams.Front();
+    bool vrestart;
+    const int vos = BeginOversample( vrestart );
+    if ( vos == 1 )
+    {
+        Render( apOut, apCtl, acFMAmount, acSamples );
+        return;
+    }
+    if ( vrestart )
+    {
+        mDecim2Q.Reset();
+        mDecim4Q.Reset();
+    }
+
+    // see GenDyn::Process()
+    int16_t vbuf[OVERSAMPLE_CHUNK * OVERSAMPLE_MAX];
+    int16_t vctl[OVERSAMPLE_CHUNK * OVERSAMPLE_MAX];
+    while ( acSamples > 0 )
+    {
+        const int vn = acSamples < OVERSAMPLE_CHUNK ? acSamples : OVERSAMPLE_CHUNK;
+        if ( apCtl )
+        {
+            int16_t* vdst = vctl;
+            for ( int i=0; i < vn; ++i )
+                for ( int k=0; k < vos; ++k ) *vdst++ = apCtl[i];
+            apCtl += vn;
+        }
+        Render( vbuf, apCtl ? vctl : NULL, acFMAmount, vn * vos );
+        if ( vos == 4 ) mDecim4Q.Process( vbuf, vbuf, 2 * vn );
+        mDecim2Q.Process( vbuf, apOut, vn );
+        apOut += vn;
+        acSamples -= vn;
+    }
+}
+
+void GenDynFixed::Render ( int16_t *apOut, const int16_t *apCtl, float acFMAmount, int acSamples )
+{
+    int16_t* out = apOut;
+    const int16_t* ctl = apCtl;
+    int n = acSamples;
+
+    uint32_t x = mPhase;
+    int32_t vprevval = mPrevValQ;
+    int32_t vprevout = mPrevOutQ;
+
+    if ( acFMAmount == 0.f || !ctl )
+    {
+        UpdateNumKP( mBlock.mFreq );
+        const float vdxset = mdx;
+        uint32_t vdx = (uint32_t)( SegmentDx( vdxset ) * Q31_ONE );
+
+        while ( n > 0 )
+        {
+            if ( x >= PHASE_ONE ) 
+            {
+                x -= PHASE_ONE;
+                NewSegmentFixed( ctl ? *ctl : 0 );
+                vdx = (uint32_t)( SegmentDx( vdxset ) * Q31_ONE );
+            }
+
+            // samples with x < 1 in the current segment, exact in fixed point
+            int vrun = (int)( ( PHASE_ONE - 1 - x ) / vdx ) + 1;
+            if ( vrun > n ) vrun = n;
+            n -= vrun;
+            if ( ctl ) ctl += vrun;
+
+            const int32_t c0 = mQ0;
+            const int32_t c1 = mQ1;
+            const int32_t c2 = mQ2;
+            while ( vrun-- )
+            {
+                int32_t val = Interp( x, c0, c1, c2 );
+                x += vdx;
+
+                // dc blocking filter
+                int32_t vout = val - vprevval + ( multiply_32x32_rshift32_rounded( vprevout, DC_COEF_Q31 ) << 1 );
+                vprevout = vout;
+                vprevval = val;
+                *out++ = signed_saturate_rshift( vout, 16, 13 );
+            }
+        }
+    }
+    else
+    {
+        // FM: step from the ctl signal every sample, kept in [0, 0.99]
+        const float vfreq = mBlock.mFreq;
+        const float vinvsr = mBlock.mInvSR;
+        const float vfrange = min(FREQ_MAX-vfreq, vfreq-FREQ_MIN);
+        const float vfmdepth = acFMAmount * vfrange * (1.f/32768.f);
+        float vkpsr = mNumKP * vinvsr * mDurMul;
+
+        while ( n-- )
+        {
+            const float vf = vfreq + vfmdepth * (*ctl);
+
+            if ( x >= PHASE_ONE ) 
+            {
+                x -= PHASE_ONE;
+                UpdateNumKP( vf );
+                NewSegmentFixed( *ctl );
+                vkpsr = mNumKP * vinvsr * mDurMul;
+            }
+
+            int32_t val = Interp( x, mQ0, mQ1, mQ2 );
+
+            float vdx = vf * vkpsr;
+            if ( vdx >= 0.99f ) vdx = 0.99f;
+            if ( vdx < 0.f ) vdx = 0.f;
+            x += (uint32_t)( vdx * Q31_ONE );
+
+            int32_t vout = val - vprevval + ( multiply_32x32_rshift32_rounded( vprevout, DC_COEF_Q31 ) << 1 );
+            vprevout = vout;
+            vprevval = val;
+            *out++ = signed_saturate_rshift( vout, 16, 13 );
+
+            ctl++;
+        }
+    }
+
+    mPhase = x;
+    mPrevValQ = vprevval;
+    mPrevOutQ = vprevout;
+}
+
+void GenDynFixed::ProcessLfo ( int16_t *apOut, int acSamples )
+{
+    int16_t* out = apOut;
+    int n = acSamples;
+
+    mBlock = mParams.Front();
+    mBlock.mOversample = 1;
+    mOversampleRun = 1; // the decimators restart on the next oversampled block
+    UpdateNumKP( mBlock.mFreq );
+    float vdxset = mdx * LFO_DECIM;
+    if ( vdxset >= 0.99f ) vdxset = 0.99f;
+    uint32_t vdx = (uint32_t)( SegmentDx( vdxset ) * Q31_ONE );
+
+    int32_t vcur = mLfoCurQ;
+
+    while ( n > 0 )
+    {
+        if ( mLfoCount == 0 )
+        {
+            if ( mPhase >= PHASE_ONE )
+            {
+                mPhase -= PHASE_ONE;
+                NewSegmentFixed( 0 );
+                vdx = (uint32_t)( SegmentDx( vdxset ) * Q31_ONE );
+            }
+            int32_t val = Interp( mPhase, mQ0, mQ1, mQ2 );
+            mPhase += vdx;
+
+            int32_t vout = val - mPrevValQ + ( multiply_32x32_rshift32_rounded( mPrevOutQ, DC_COEF_LFO_Q31 ) << 1 );
+            mPrevOutQ = vout;
+            mPrevValQ = val;
+
+            vcur = mLfoNextQ;
+            mLfoNextQ = vout;
+            mLfoIncQ = ( vout - vcur ) >> LFO_DECIM_SHIFT;
+            mLfoCount = LFO_DECIM;
+        }
+
+        int vrun = mLfoCount < n ? mLfoCount : n;
+        n -= vrun;
+        mLfoCount -= vrun;
+        const int32_t vinc = mLfoIncQ;
+        while ( vrun-- )
+        {
+            vcur += vinc;
+            *out++ = signed_saturate_rshift( vcur, 16, 13 );
+        }
+    }
+
+    mLfoCurQ = vcur;
+}
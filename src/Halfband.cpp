@@ -0,0 +1,43 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#include "Halfband.h"
+
+// the branch sums to 0.5 (Q15: 16384), unity gain at dc with the center tap
+#define HB_PACK(a,b) ( ( (uint32_t)(uint16_t)(int16_t)(a) << 16 ) | (uint16_t)(int16_t)(b) )
+
+// Kaiser, beta 6
+template <> const float HalfbandCoefs<HALFBAND_LONG>::cFloat[HALFBAND_LONG] = {
+   -0.000315589f, 0.001767719f, -0.005208734f, 0.011989062f, -0.024251087f, 0.046589055f, -0.094995013f, 0.314424587f,
+   0.314424587f, -0.094995013f, 0.046589055f, -0.024251087f, 0.011989062f, -0.005208734f, 0.001767719f, -0.000315589f
+};
+template <> const uint32_t HalfbandCoefs<HALFBAND_LONG>::cPacked[HALFBAND_LONG/2] = {
+   HB_PACK( -10, 58 ), HB_PACK( -171, 393 ), HB_PACK( -795, 1527 ), HB_PACK( -3113, 10303 ),
+   HB_PACK( 10303, -3113 ), HB_PACK( 1527, -795 ), HB_PACK( 393, -171 ), HB_PACK( 58, -10 )
+};
+
+// Kaiser, beta 7
+template <> const float HalfbandCoefs<HALFBAND_SHORT>::cFloat[HALFBAND_SHORT] = {
+   -0.000269671f, 0.009397768f, -0.056930436f, 0.297802339f,
+   0.297802339f, -0.056930436f, 0.009397768f, -0.000269671f
+};
+template <> const uint32_t HalfbandCoefs<HALFBAND_SHORT>::cPacked[HALFBAND_SHORT/2] = {
+   HB_PACK( -9, 308 ), HB_PACK( -1865, 9758 ),
+   HB_PACK( 9758, -1865 ), HB_PACK( 308, -9 )
+};
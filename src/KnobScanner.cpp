@@ -0,0 +1,138 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Background knob scanner (Teensy only)
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#include "KnobScanner.h"
+#include <ADC.h>
+#include <IntervalTimer.h>
+
+static ADC gAdc;
+static IntervalTimer gScanTimer;
+
+int KnobScanner::mMuxPin = -1;
+int KnobScanner::mSelectPins[KNOB_MUX_SELECT_PINS];
+int KnobScanner::mDirectPins[KNOB_MAX_DIRECT];
+int KnobScanner::mNumDirect = 0;
+
+volatile uint16_t KnobScanner::mValue[KNOB_MAX_CHANNELS];
+volatile uint32_t KnobScanner::mScans = 0;
+uint32_t KnobScanner::mState[KNOB_MAX_CHANNELS];
+bool KnobScanner::mPrimed[KNOB_MAX_CHANNELS];
+int KnobScanner::mMuxChannel = 0;
+int KnobScanner::mDirectChannel = 0;
+bool KnobScanner::mMuxBusy = false;
+bool KnobScanner::mDirectBusy = false;
+
+void KnobScanner::Begin( int acMuxPin, const int* apSelectPins, const int* apDirectPins, int acNumDirect ){
+   mMuxPin = acMuxPin;
+   mNumDirect = min( acNumDirect, KNOB_MAX_DIRECT );
+   for ( int i=0; i < KNOB_MUX_SELECT_PINS; ++i ) {
+      mSelectPins[i] = apSelectPins[i];
+      pinMode( mSelectPins[i], OUTPUT );
+   }
+   for ( int i=0; i < mNumDirect; ++i ) {
+      mDirectPins[i] = apDirectPins[i];
+      pinMode( mDirectPins[i], INPUT );
+   }
+   pinMode( mMuxPin, INPUT );
+   for ( int c=0; c < KNOB_MAX_CHANNELS; ++c ) {
+      mValue[c] = 0;
+      mState[c] = 0;
+      mPrimed[c] = false;
+   }
+   mMuxChannel = 0;
+   mDirectChannel = 0;
+   SelectMux( 0 );
+
+   // the mux pin on ADC0, the direct pins on ADC1, converting in parallel
+   ADC_Module* vadcs[2] = { gAdc.adc0, gAdc.adc1 };
+   for ( int i=0; i < 2; ++i ) {
+      vadcs[i]->setResolution( KNOB_RESOLUTION );
+      vadcs[i]->setAveraging( 4 );
+      vadcs[i]->setConversionSpeed( ADC_CONVERSION_SPEED::MED_SPEED );
+      vadcs[i]->setSamplingSpeed( ADC_SAMPLING_SPEED::MED_SPEED );
+   }
+   gAdc.adc0->enableInterrupts( MuxDone, KNOB_IRQ_PRIORITY );
+   gAdc.adc1->enableInterrupts( DirectDone, KNOB_IRQ_PRIORITY );
+
+   gScanTimer.priority( KNOB_IRQ_PRIORITY );
+   gScanTimer.begin( Tick, KNOB_SCAN_PERIOD_US );
+}
+
+// a conversion still running (it shouldn't at this period) skips the tick
+void KnobScanner::Tick(){
+   if ( !mMuxBusy ) {
+      mMuxBusy = true;
+      gAdc.adc0->startSingleRead( mMuxPin );
+   }
+   if ( mNumDirect > 0 && !mDirectBusy ) {
+      mDirectBusy = true;
+      gAdc.adc1->startSingleRead( mDirectPins[mDirectChannel] );
+   }
+}
+
+void KnobScanner::MuxDone(){
+   Filter( mMuxChannel, gAdc.adc0->readSingle() );
+
+   // next channel settles until the next tick
+   mMuxChannel++;
+   if ( mMuxChannel >= KNOB_MUX_CHANNELS ) {
+      mMuxChannel = 0;
+      mScans++; // the direct pins go round faster than the mux
+   }
+   SelectMux( mMuxChannel );
+   mMuxBusy = false;
+#if defined(__IMXRT1062__)
+   asm("DSB");
+#endif
+}
+
+void KnobScanner::DirectDone(){
+   Filter( KNOB_MUX_CHANNELS + mDirectChannel, gAdc.adc1->readSingle() );
+
+   mDirectChannel++;
+   if ( mDirectChannel >= mNumDirect ) mDirectChannel = 0;
+   mDirectBusy = false;
+#if defined(__IMXRT1062__)
+   asm("DSB");
+#endif
+}
+
+// select pins are the channel bits, s0 = lsb
+void KnobScanner::SelectMux( int acChannel ){
+   for ( int i=0; i < KNOB_MUX_SELECT_PINS; ++i ) {
+      digitalWrite( mSelectPins[i], ( acChannel >> i ) & 1 );
+   }
+}
+
+// one-pole lowpass in Q16, the first reading sets the state
+void KnobScanner::Filter( int acChannel, int acRaw ){
+   const uint32_t vx = (uint32_t)acRaw << 16;
+   uint32_t vstate = mState[acChannel];
+   if ( !mPrimed[acChannel] ) {
+      vstate = vx;
+      mPrimed[acChannel] = true;
+   }
+   else {
+      vstate += (int32_t)( vx - vstate ) >> KNOB_FILTER_SHIFT;
+   }
+   mState[acChannel] = vstate;
+   mValue[acChannel] = (uint16_t)( ( vstate + 0x8000 ) >> 16 ); // 16 bit store, no tearing
+}
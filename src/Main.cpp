@@ -23,7 +23,8 @@
 #include "Eris.h"
 #include <Wire.h>
 #include <SPI.h>
-#include <Smoothed.h>
+#include "KnobScanner.h"
+#include "ControlMap.h"
 
 //-------------------------------------------------------------------
 // Global Defs
@@ -33,8 +34,9 @@
 #define ENABLE_MIDI
 #define INT_LED 13
 #define LOOP_TIME 1  // control rate (ms) 
-#define KNOB_FILTER_LENGTH 20
 
+#define NUM_VOICES 1 // up to ERIS_MAX_VOICES, 1 keeps the mono key buffer (last note priority)
+#define OVERSAMPLE 1 // 1, 2 or 4: less aliasing at high rates, each step doubles the oscillators' cost
 #define KS_BIASGAIN 25 // keyswitch to set AR bias gain with Master knob
 bool masterKnobSetsBiasGain = true;
 
@@ -56,32 +58,11 @@ AudioConnection          patchCord1( module, 0, output, 0 );
 AudioConnection          patchCord2( module, 1, output, 1 );
 
 //-------------------------------------------------------------------
-// Multiplexer 
+// Multiplexer + direct analog inputs, scanned in the background
 static const int cSIG_pin = A0;
 static const int cControlPin[] = {12,11,10}; // s0,s1,s2 
-static const int cNumMuxChannels = 8;
-
-static const int cMuxChannel[cNumMuxChannels][3]={
-    {0,0,0}, //channel 0
-    {1,0,0}, //channel 1
-    {0,1,0}, //channel 2
-    {1,1,0}, //channel 3
-    {0,0,1}, //channel 4
-    {1,0,1}, //channel 5
-    {0,1,1}, //channel 6
-    {1,1,1}, //channel 7
-  };
-
-int readMux( int channel ){
-  for( int i = 0; i < 3; i++ ){
-    digitalWrite( cControlPin[i], cMuxChannel[channel][i]);
-  }
-
-  delayMicroseconds(200);
-  int val = analogRead(cSIG_pin);
-
-  return val;
-}
+static const int cDirectPins[] = {A1,A2,A3,A4,A5};
+static const int cNumDirectPins = 5;
 
 //-------------------------------------------------------------------
 // KNOBS MAPPING 
@@ -106,95 +87,50 @@ enum AnalogMap
     cNumKnobs
 };
 
-Smoothed <float> knob[cNumKnobs]; 
+// response curve, range and setter of each knob (AnalogMap order)
+struct KnobConfig
+{
+    ControlCurve curve;
+    float min;
+    float max;
+    void (Eris::*set)( float );
+};
 
-//--------------------------------------------------------------------
-void ReadKnobs(){
+static const KnobConfig cKnobConfig[cNumKnobs] = {
+    { ControlCurve_Square, 100.f, 10000.f,      &Eris::SetCutoff },     // CUT
+    { ControlCurve_Square, 0.f,   MAX_OSC_GAIN, &Eris::SetGen1Gain },   // GAIN1
+    { ControlCurve_Square, 0.f,   1.f,          &Eris::SetGen1Rate },   // RATE1
+    { ControlCurve_Linear, 0.7f,  5.f,          &Eris::SetResonance },  // RES
+    { ControlCurve_Linear, 0.f,   1.f,          &Eris::SetGen1Dist },   // DIST1
+    { ControlCurve_Square, 0.f,   1.f,          &Eris::SetGen2Rate },   // RATE2
+    { ControlCurve_Linear, 0.f,   1.f,          &Eris::SetGen1Scale },  // SCALE1
+    { ControlCurve_Linear, 0.f,   1.f,          &Eris::SetGen1Param },  // PAR1
+    { ControlCurve_Square, 0.f,   MAX_OSC_GAIN, &Eris::SetGen2Gain },   // GAIN2
+    { ControlCurve_Linear, 0.f,   1.f,          &Eris::SetGen2Param },  // PAR2
+    { ControlCurve_Linear, 0.f,   1.f,          &Eris::SetGen2Scale },  // SCALE2
+    { ControlCurve_Linear, 0.f,   1.f,          &Eris::SetGen2Dist },   // DIST2
+    // This master knob sets the VCA Bias Gain - bypassed when Receiving MIDI
+    { ControlCurve_Square, 0.f,   1.f,          &Eris::SetVCABiasGain } // MASTER
+};
 
-      // Read from Mux (MA0..MA7)
-      for (int i = 0; i < 8; i++){
-          knob[i].add( readMux(i) );
-      }
+ControlMap controls;
 
-      // Read Teensy Analogs (A1...A5)
-      knob[GAIN2].add( analogRead(A1) );   
-      knob[PAR2].add( analogRead(A2) );
-      knob[SCALE2].add( analogRead(A3) );
-      knob[DIST2].add( analogRead(A4) );
-      knob[MASTER].add( analogRead(A5) );
-
-      // Filter & Dispatch
-     for (int k=0; k < cNumKnobs; k++ ){
-
-        float val = knob[k].get();
-        float vval = (float)val / 1023.f;
-
-        switch (k)
-        {
-            case CUT:
-                vval *= vval;
-                vval = map( vval, 0.f, 1.f, 100.f, 10000.f );
-                module.SetCutoff(vval);
-            break;
-
-            case RES:
-                vval = map( vval, 0.f, 1.f, 0.7, 5.0 );
-                module.SetResonance(vval);
-            break;
-            
-            case GAIN2:
-                vval *= vval;
-                module.SetGen2Gain( vval * MAX_OSC_GAIN );
-            break;
-            
-            case MASTER:
-                // This master knob sets the VCA Bias Gain - bypassed when Receiving MIDI
-                vval *= vval;
-                module.SetVCABiasGain(vval);
-            break;
-            
-            case SCALE2:
-                module.SetGen2Scale(vval);
-            break;
-            
-            case PAR1:
-                module.SetGen1Param(vval);
-            break;
-            
-            case SCALE1:
-                module.SetGen1Scale(vval);
-            break;
-            
-            case PAR2:
-                module.SetGen2Param(vval);
-            break;
-
-            case GAIN1:
-                vval *= vval;
-                module.SetGen1Gain( vval * MAX_OSC_GAIN );
-            break;
-            
-            case DIST2:
-                module.SetGen2Dist(vval);
-            break;            
-            
-            case DIST1:
-                module.SetGen1Dist(vval);
-            break;
-
-            case RATE2:
-                vval *= vval;
-                module.SetGen2Rate(vval);
-            break;
-
-            case RATE1:
-                vval *= vval;
-                module.SetGen1Rate(vval);
-            break;
-
-            default:
-            break;
-        } 
+void SetupKnobs(){
+    for (int k=0; k < cNumKnobs; k++ ){
+        controls.Setup( k, cKnobConfig[k].curve, cKnobConfig[k].min, cKnobConfig[k].max );
+    }
+}
+
+//--------------------------------------------------------------------
+// Dispatch the knobs that moved past their deadband
+void ReadKnobs(){
+    // changes that didn't fit in the event queue last time
+    module.FlushParams();
+    // values filtered by the KnobScanner, channel order = AnalogMap
+    for (int k=0; k < cNumKnobs; k++ ){
+        if ( controls.Update( k, KnobScanner::Value(k) ) ) {
+            (module.*cKnobConfig[k].set)( controls.Value(k) );
+        }
     }
 }
 
@@ -276,6 +212,19 @@ void ControlChange(byte channel, byte cc, byte val) {
     case 73:
       module.SetVCABiasGain( (float)val * DIV127);
       break;
+    // stochastic durations
+    case 75:
+      module.SetGen1DurScale( (float)val * DIV127);
+      break;
+    case 76:
+      module.SetGen1DurDist( (float)val * DIV127);
+      break;
+    case 77:
+      module.SetGen2DurScale( (float)val * DIV127);
+      break;
+    case 78:
+      module.SetGen2DurDist( (float)val * DIV127);
+      break;
     
     default:
       break;
@@ -287,6 +236,10 @@ void NoteOn(byte channel, byte note, byte velocity) {
   //masterKnobSetsBiasGain = false;
   mCurNote = note;
   mCurVelocity = velocity;
+  if ( NUM_VOICES > 1 ) {
+    module.NoteOn(note, velocity);
+    return;
+  }
   ManageKey(note, true);
 }
 
@@ -295,6 +248,10 @@ void NoteOff(byte channel, byte note, byte velocity){
     masterKnobSetsBiasGain = false;
     return;
   }
+  if ( NUM_VOICES > 1 ) {
+    module.NoteOff(note);
+    return;
+  }
   ManageKey(note, false);
 }
 
@@ -304,14 +261,9 @@ void setup(){
     AudioMemory(NUM_MEMORY_BLOCKS);
     //AudioNoInterrupts();
 
-    // Mux INIT
-    pinMode(cControlPin[0], OUTPUT);
-    pinMode(cControlPin[1], OUTPUT); 
-    pinMode(cControlPin[2], OUTPUT); 
-
-    digitalWrite(cControlPin[0], LOW);
-    digitalWrite(cControlPin[1], LOW);
-    digitalWrite(cControlPin[2], LOW);
+    // Knobs: mux + analog pins scanned from the ADC interrupts
+    KnobScanner::Begin(cSIG_pin, cControlPin, cDirectPins, cNumDirectPins);
+    SetupKnobs();
 
     pinMode(RATEMOD, INPUT_PULLUP);
     pinMode(GEN2OUT, INPUT_PULLUP); 
@@ -327,16 +279,11 @@ void setup(){
     AudioMemoryUsageMaxReset();
 #endif
 
-    // init knobs
-    for (int k=0; k < cNumKnobs; k++ ){
-        knob[k].begin(SMOOTHED_AVERAGE, KNOB_FILTER_LENGTH);
-    }
-
     float vpSeeds[NUM_CONTROL_PTS_MAX];
     int navailseeds = min(NUM_CONTROL_PTS_MAX,cNumKnobs);
     for ( int i=0; i < navailseeds; i++ ) {
          // Init GenDyns using status of the synth knobs
-        //vpSeeds[i] = 2.f * (float)knob[i].get() / 1023.f - 1.f;
+        //vpSeeds[i] = 2.f * (float)KnobScanner::Value(i) / 1023.f - 1.f;
         vpSeeds[i] = 0.f;
     }
     if ( navailseeds < NUM_CONTROL_PTS_MAX){
@@ -348,6 +295,8 @@ void setup(){
     }
 
     module.Init(vpSeeds);
+    module.SetNumVoices(NUM_VOICES);
+    module.SetOversample(OVERSAMPLE);
 
     // init Params
     module.SetGen1Rate(0.15f);
@@ -386,18 +335,31 @@ void setup(){
 void loop(){
 
 #ifdef ENABLE_MIDI
+    // polled every pass, the knobs no longer block the loop
     usbMIDI.read();
 #endif
 
-    ReadKnobs();
-    ReadSwitches();
-    ControlLed();
+    static uint32_t vLastControl = 0;
+    if ( millis() - vLastControl >= LOOP_TIME ) {
+        vLastControl = millis();
+        ReadKnobs();
+        ReadSwitches();
+        ControlLed();
 
 #ifdef CPU_TEST
-    Serial.print("CPU CURRENT: "); Serial.print(AudioProcessorUsage());
-    Serial.print(" CPU MAX: "); Serial.println(AudioProcessorUsageMax());
+        Serial.print("CPU CURRENT: "); Serial.print(AudioProcessorUsage());
+        Serial.print(" CPU MAX: "); Serial.println(AudioProcessorUsageMax());
 #endif
+    }
 
-    delay(LOOP_TIME);
+#ifdef ERIS_PROFILE
+    // per-stage cycles of Eris::update(), once per second
+    static uint32_t vLastDump = 0;
+    if ( millis() - vLastDump >= 1000 ) {
+        vLastDump = millis();
+        Profiler::Dump(Serial);
+        Serial.println();
+    }
+#endif
 }
 
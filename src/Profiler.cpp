@@ -0,0 +1,83 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   Per-stage cycle count profiler for Eris::update()
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#include "Profiler.h"
+
+uint32_t Profiler::mBlock[cNumProfStages];
+ProfStats Profiler::mStats[cNumProfStages];
+uint32_t Profiler::mMark;
+uint32_t Profiler::mBlockStart;
+
+static const char* const gcStageNames[cNumProfStages] = {
+   "io", "gen2", "gen1", "conv", "gain", "mix", "vcf", "env", "total"
+};
+
+void Profiler::Commit(){
+   for ( int s=0; s < cNumProfStages; ++s ) {
+      const uint32_t vcycles = mBlock[s];
+      mBlock[s] = 0;
+      ProfStats& st = mStats[s];
+      if ( st.count == 0 || vcycles < st.min ) st.min = vcycles;
+      if ( vcycles > st.max ) st.max = vcycles;
+      st.sum += vcycles;
+      st.count++;
+
+      int vbin = 0;
+      if ( vcycles > 0 ) {
+         vbin = ( 31 - __builtin_clz(vcycles) ) - PROF_HIST_MIN_LOG2 + 1;
+         if ( vbin < 0 ) vbin = 0;
+         if ( vbin > PROF_HIST_BINS - 1 ) vbin = PROF_HIST_BINS - 1;
+      }
+      st.hist[vbin]++;
+   }
+}
+
+void Profiler::Reset(){
+   __disable_irq();
+   memset( mBlock, 0, sizeof(mBlock) );
+   memset( mStats, 0, sizeof(mStats) );
+   __enable_irq();
+}
+
+const char* Profiler::StageName( ProfStage acStage ){
+   return ( acStage >= 0 && acStage < cNumProfStages ) ? gcStageNames[acStage] : "?";
+}
+
+void Profiler::Dump( Print& aOut ){
+   for ( int s=0; s < cNumProfStages; ++s ) {
+      // copy with interrupts off, print with interrupts on
+      __disable_irq();
+      ProfStats st = mStats[s];
+      __enable_irq();
+
+      aOut.print( StageName( (ProfStage)s ) );
+      aOut.print( " n=" ); aOut.print( st.count );
+      aOut.print( " min=" ); aOut.print( st.min );
+      aOut.print( " avg=" ); aOut.print( (uint32_t)( st.Mean() + 0.5f ) );
+      aOut.print( " max=" ); aOut.print( st.max );
+      aOut.print( " |" );
+      for ( int b=0; b < PROF_HIST_BINS; ++b ) {
+         aOut.print( ' ' );
+         aOut.print( st.hist[b] );
+      }
+      aOut.println();
+   }
+}
@@ -0,0 +1,32 @@
+/*
+   Eris - Dynamic Stochastic Synthesizer
+   Spare Knobs 2020-2024
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#include "Taps.h"
+
+TapHook Taps::mpHook = 0;
+void* Taps::mpUser = 0;
+int Taps::mVoice = 0;
+
+static const char* const gcPointNames[cNumTapPoints] = {
+   "gen2", "gen1", "vcf", "env"
+};
+
+const char* Taps::PointName( TapPoint acPoint ){
+   return ( acPoint >= 0 && acPoint < cNumTapPoints ) ? gcPointNames[acPoint] : "?";
+}
@@ -57,82 +57,171 @@
 // no audible difference.
 //#define IMPROVE_EXPONENTIAL_ACCURACY
 
-void VCFixed::Process(const int16_t *in, int16_t *out, const int16_t *ctl, const int acsamples)
+// exp2 of the scaled control: the multiplier of fcenter
+static inline int32_t ControlExp2(int32_t control)
 {
-	const int16_t *end = in + acsamples;
-	int32_t input, inputprev, control;
+	int32_t n = control & 0x7FFFFFF;   // 27 fractional control bits
+	#ifdef IMPROVE_EXPONENTIAL_ACCURACY
+	// exp2 polynomial suggested by Stefan Stenzel on "music-dsp"
+	// mail list, Wed, 3 Sep 2014 10:08:55 +0200
+	int32_t x = n << 3;
+	n = multiply_accumulate_32x32_rshift32_rounded(536870912, x, 1494202713);
+	int32_t sq = multiply_32x32_rshift32_rounded(x, x);
+	n = multiply_accumulate_32x32_rshift32_rounded(n, sq, 1934101615);
+	n = n + (multiply_32x32_rshift32_rounded(sq,
+		multiply_32x32_rshift32_rounded(x, 1358044250)) << 1);
+	n = n << 1;
+	#else
+	// exp2 algorithm by Laurent de Soras
+	// https://www.musicdsp.org/en/latest/Other/106-fast-exp2-approximation.html
+	n = (n + 134217728) << 3;
+	n = multiply_32x32_rshift32_rounded(n, n);
+	n = multiply_32x32_rshift32_rounded(n, 715827883) << 3;
+	n = n + 715827882;
+	#endif
+	return n >> (6 - (control >> 27)); // 4 integer control bits
+}
+
+// CUTOFF_MIN..CUTOFF_MAX as fmult before the << 8, as VCFloat clamps it
+static const int32_t cFmultMin = (int32_t)(CUTOFF_MIN * (3.141592654f/(ERIS_SAMPLE_RATE*2.0f)) * 8388608.0f);
+static const int32_t cFmultMax = (int32_t)(CUTOFF_MAX * (3.141592654f/(ERIS_SAMPLE_RATE*2.0f)) * 8388608.0f);
+
+static inline int32_t CenterToFmult(int32_t fcenter, int32_t n)
+{
+	int32_t fmult = multiply_32x32_rshift32_rounded(fcenter, n);
+	if (fmult < cFmultMin) fmult = cFmultMin;
+	if (fmult > cFmultMax) fmult = cFmultMax;
+	fmult = fmult << 8;
+	// fmult is within 0.4% accuracy for all but the top 2 octaves
+	// of the audio band.  This math improves accuracy above 5 kHz.
+	// Without this, the filter still works fine for processing
+	// high frequencies, but the filter's corner frequency response
+	// can end up about 6% higher than requested.
+	#ifdef IMPROVE_HIGH_FREQUENCY_ACCURACY
+	// From "Fast Polynomial Approximations to Sine and Cosine"
+	// Charles K Garrett, http://krisgarrett.net/
+	fmult = (multiply_32x32_rshift32_rounded(fmult, 2145892402) +
+		multiply_32x32_rshift32_rounded(
+		multiply_32x32_rshift32_rounded(fmult, fmult),
+		multiply_32x32_rshift32_rounded(fmult, -1383276101))) << 1;
+	#endif
+	return fmult;
+}
+
+// before the first block, the ramp starts at the corner of fcenter alone
+void VCFixed::ResetCorner()
+{
+	state_fmult = CenterToFmult(setting_fcenter, ControlExp2(0));
+}
+
+void VCFixed::Process(const int16_t *in, int16_t *out, const int16_t *ctl, const int acsamples, const int acctlstep)
+{
+	switch (mode_) {
+	case FilterMode_LowPass:  Run<FilterMode_LowPass>(in, out, ctl, acsamples, acctlstep); break;
+	case FilterMode_BandPass: Run<FilterMode_BandPass>(in, out, ctl, acsamples, acctlstep); break;
+	case FilterMode_HighPass: Run<FilterMode_HighPass>(in, out, ctl, acsamples, acctlstep); break;
+	case FilterMode_Notch:    Run<FilterMode_Notch>(in, out, ctl, acsamples, acctlstep); break;
+	case FilterMode_Peak:     Run<FilterMode_Peak>(in, out, ctl, acsamples, acctlstep); break;
+	default:                  Run<FilterMode_Morph>(in, out, ctl, acsamples, acctlstep); break;
+	}
+}
+
+// mode is a constant, the branches below fold away
+template <FilterMode mode>
+void VCFixed::Run(const int16_t *in, int16_t *out, const int16_t *ctl, const int acsamples, const int acctlstep)
+{
+	int32_t input, inputprev;
 	int32_t lowpass, bandpass, highpass;
 	int32_t lowpasstmp, bandpasstmp, highpasstmp;
-	int32_t fcenter, fmult, damp, octavemult;
+	int32_t fcenter, fmult, fmultinc, damp, octavemult;
+	int32_t fcenterinc, dampinc;
+	int32_t mlp, mbp, mhp;
 	int32_t n;
+	int pos, len;
+	bool constctl;
 
-	fcenter = setting_fcenter;
+	mFcenter.NextBlock(acsamples);
+	mDamp.NextBlock(acsamples);
+	fcenter = mFcenter.Start();
+	fcenterinc = mFcenter.Inc();
+	damp = mDamp.Start();
+	dampinc = mDamp.Inc();
 	octavemult = setting_octavemult;
-	damp = setting_damp;
+	mlp = morph_lp;
+	mbp = morph_bp;
+	mhp = morph_hp;
 	inputprev = state_inputprev;
 	lowpass = state_lowpass;
 	bandpass = state_bandpass;
-	do {
-		// compute fmult using control input, fcenter and octavemult
-		control = *ctl++;          // signal is always 15 fractional bits
-		control *= octavemult;     // octavemult range: 0 to 28671 (12 frac bits)
-		n = control & 0x7FFFFFF;   // 27 fractional control bits
-		#ifdef IMPROVE_EXPONENTIAL_ACCURACY
-		// exp2 polynomial suggested by Stefan Stenzel on "music-dsp"
-		// mail list, Wed, 3 Sep 2014 10:08:55 +0200
-		int32_t x = n << 3;
-		n = multiply_accumulate_32x32_rshift32_rounded(536870912, x, 1494202713);
-		int32_t sq = multiply_32x32_rshift32_rounded(x, x);
-		n = multiply_accumulate_32x32_rshift32_rounded(n, sq, 1934101615);
-		n = n + (multiply_32x32_rshift32_rounded(sq,
-			multiply_32x32_rshift32_rounded(x, 1358044250)) << 1);
-		n = n << 1;
-		#else
-		// exp2 algorithm by Laurent de Soras
-		// https://www.musicdsp.org/en/latest/Other/106-fast-exp2-approximation.html
-		n = (n + 134217728) << 3;
-		n = multiply_32x32_rshift32_rounded(n, n);
-		n = multiply_32x32_rshift32_rounded(n, 715827883) << 3;
-		n = n + 715827882;
-		#endif
-		n = n >> (6 - (control >> 27)); // 4 integer control bits
-		fmult = multiply_32x32_rshift32_rounded(fcenter, n);
-		if (fmult > 5378279) fmult = 5378279;
-		fmult = fmult << 8;
-		// fmult is within 0.4% accuracy for all but the top 2 octaves
-		// of the audio band.  This math improves accuracy above 5 kHz.
-		// Without this, the filter still works fine for processing
-		// high frequencies, but the filter's corner frequency response
-		// can end up about 6% higher than requested.
-		#ifdef IMPROVE_HIGH_FREQUENCY_ACCURACY
-		// From "Fast Polynomial Approximations to Sine and Cosine"
-		// Charles K Garrett, http://krisgarrett.net/
-		fmult = (multiply_32x32_rshift32_rounded(fmult, 2145892402) +
-			multiply_32x32_rshift32_rounded(
-			multiply_32x32_rshift32_rounded(fmult, fmult),
-			multiply_32x32_rshift32_rounded(fmult, -1383276101))) << 1;
-		#endif
-		// now do the state variable filter as normal, using fmult
-		input = (*in++) << 12;
-		lowpass = lowpass + MULT(fmult, bandpass);
-		highpass = ((input + inputprev)>>1) - lowpass - MULT(damp, bandpass);
-		inputprev = input;
-		bandpass = bandpass + MULT(fmult, highpass);
-		lowpasstmp = lowpass;
-		bandpasstmp = bandpass;
-		highpasstmp = highpass;
-		lowpass = lowpass + MULT(fmult, bandpass);
-		highpass = input - lowpass - MULT(damp, bandpass);
-		bandpass = bandpass + MULT(fmult, highpass);
-		lowpasstmp = signed_saturate_rshift(lowpass+lowpasstmp, 16, 13);
-		bandpasstmp = signed_saturate_rshift(bandpass+bandpasstmp, 16, 13);
-		highpasstmp = signed_saturate_rshift(highpass+highpasstmp, 16, 13);
-		*out++ = lowpasstmp;
-		//*bp++ = bandpasstmp;
-		//*hp++ = highpasstmp;
-	} while (in < end);
+	fmult = state_fmult;
+
+	// no modulation, or a flat control block: one exp2 for the block
+	constctl = ctl == NULL || octavemult == 0;
+	if (!constctl) {
+		constctl = true;
+		for (pos = 1; pos < acsamples && constctl; pos++) constctl = ctl[pos] == ctl[0];
+	}
+	n = ControlExp2(constctl && ctl ? ctl[0] * octavemult : 0);
+
+	// fmult is worked out per segment: the whole block when nothing moves,
+	// every acctlstep samples (ramped in between) for a slow control,
+	// every sample otherwise
+	pos = 0;
+	while (pos < acsamples) {
+		fmultinc = 0;
+		if (constctl && fcenterinc == 0) {
+			len = acsamples - pos;
+			fmult = CenterToFmult(fcenter, n);
+		} else if (constctl || acctlstep <= 1) {
+			// control signal is always 15 fractional bits,
+			// octavemult range: 0 to 28671 (12 frac bits)
+			len = 1;
+			fcenter += fcenterinc;
+			if (!constctl) n = ControlExp2(ctl[pos] * octavemult);
+			fmult = CenterToFmult(fcenter, n);
+		} else {
+			len = acsamples - pos < acctlstep ? acsamples - pos : acctlstep;
+			fcenter += fcenterinc * len;
+			fmultinc = (CenterToFmult(fcenter, ControlExp2(ctl[pos + len - 1] * octavemult)) - fmult) / len;
+		}
+		pos += len;
+
+		do {
+			fmult += fmultinc;
+			damp += dampinc;
+			// now do the state variable filter as normal, using fmult
+			input = (*in++) << 12;
+			lowpass = lowpass + MULT(fmult, bandpass);
+			highpass = ((input + inputprev)>>1) - lowpass - MULT(damp, bandpass);
+			inputprev = input;
+			bandpass = bandpass + MULT(fmult, highpass);
+			lowpasstmp = lowpass;
+			bandpasstmp = bandpass;
+			highpasstmp = highpass;
+			lowpass = lowpass + MULT(fmult, bandpass);
+			highpass = input - lowpass - MULT(damp, bandpass);
+			bandpass = bandpass + MULT(fmult, highpass);
+			if (mode == FilterMode_LowPass) {
+				*out++ = signed_saturate_rshift(lowpass+lowpasstmp, 16, 13);
+			} else if (mode == FilterMode_BandPass) {
+				*out++ = signed_saturate_rshift(bandpass+bandpasstmp, 16, 13);
+			} else if (mode == FilterMode_HighPass) {
+				*out++ = signed_saturate_rshift(highpass+highpasstmp, 16, 13);
+			} else if (mode == FilterMode_Notch) {
+				*out++ = signed_saturate_rshift(lowpass+lowpasstmp+highpass+highpasstmp, 16, 13);
+			} else if (mode == FilterMode_Peak) {
+				*out++ = signed_saturate_rshift(lowpass+lowpasstmp-highpass-highpasstmp, 16, 13);
+			} else {
+				// Q31 weights take one bit off the shift
+				int32_t mix = multiply_32x32_rshift32_rounded(lowpass+lowpasstmp, mlp)
+					+ multiply_32x32_rshift32_rounded(bandpass+bandpasstmp, mbp)
+					+ multiply_32x32_rshift32_rounded(highpass+highpasstmp, mhp);
+				*out++ = signed_saturate_rshift(mix, 16, 12);
+			}
+		} while (--len);
+	}
 	state_inputprev = inputprev;
 	state_lowpass = lowpass;
 	state_bandpass = bandpass;
+	state_fmult = fmult;
 }
-
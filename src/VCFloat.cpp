@@ -6,6 +6,8 @@
 
   A floating point version of the implementation by Paul Stoffregen, see:
   https://github.com/PaulStoffregen/Audio
+ 
+  */
 
 /* Audio Library for Teensy 3.X
  * Copyright (c) 2014, Paul Stoffregen, paul@pjrc.com
@@ -35,64 +37,124 @@
 
 #include <Arduino.h>
 #include "VCFloat.h"
+#include "FastMath.h"
+#include "Denormals.h"
 #include "utility/dspinst.h"
 
-void VCFloat::Process( float *apIn, float *apOut, float *apCtl )
+// filter's corner frequency is Fcenter * 2^(control * N)
+// where control ranges from 0 to +1.0
+// and "N" allows the frequency to change from 0 to 7 octaves
+inline float VCFloat::ControlToFmult( float acCutoff, float acOctavemult, float acControl )
+{
+  float vradians = acCutoff;
+  if ( acControl != 0.f ) vradians *= FastExp2( acControl * acOctavemult );
+  if ( vradians < mRadiansMin ) vradians = mRadiansMin;
+  if ( vradians > mRadiansMax ) vradians = mRadiansMax;
+  // 2x oversampled: f = 2 sin( pi * fc / (2 * sr) ), as in VCFixed
+  return 2.f * FastSin( 0.5f * vradians );
+}
+
+// see VCFixed::ResetCorner()
+void VCFloat::ResetCorner()
+{
+  mLastFmult = ControlToFmult( mCutoffRadians, mOctavemult, 0.f );
+}
+
+void VCFloat::Process( const float *apIn, float *apOut, const float *apCtl, const int acsamples, const int acCtlStep )
 {
 
-  float *in = apIn;
-  const float *end = in + AUDIO_BLOCK_SAMPLES;
-  float *ctl = apCtl;
+  const float *in = apIn;
+  const float *ctl = apCtl;
   float *out = apOut;
-  float input, inputprev, control;
+  float input, inputprev;
   float lowpass, bandpass, highpass;
-  float lowpasstmp;// bandpasstmp, highpasstmp;
-  float fmult, damp, octavemult;
+  float lowpasstmp, bandpasstmp, highpasstmp;
+  float fmult, fmultinc, damp, octavemult, cutoff;
+  const float wlp = mWeightLp;
+  const float wbp = mWeightBp;
+  const float whp = mWeightHp;
 
+  cutoff = mCutoffRadians;
   octavemult = mOctavemult;
   damp = mDamp;
   inputprev = state_inputprev;
   lowpass = state_lowpass;
   bandpass = state_bandpass;
+  fmult = mLastFmult;
 
- do 
+  // same segments as VCFixed::Process: the whole block for a flat control,
+  // acCtlStep samples for a slow one, else every sample
+  bool vconst = ctl == NULL || octavemult == 0.f;
+  if ( !vconst ) {
+    vconst = true;
+    for ( int i=1; i < acsamples && vconst; ++i ) vconst = ctl[i] == ctl[0];
+  }
+
+  int vpos = 0;
+  while ( vpos < acsamples )
   {
-     // compute fmult using control input, fcenter and octavemult
-    // filter's corner frequency is Fcenter * 2^(control * N)
-    // where control ranges from 0 to +1.0
-    // and "N" allows the frequency to change from 0 to 7 octaves
-    
-    control = *ctl++; 
-    float vradians = mCutoffRadians * powf(2.f, control * octavemult );
-    if ( vradians < mRadiansMin ) vradians = mRadiansMin;
-    if ( vradians > mRadiansMax ) vradians = mRadiansMax;
-    fmult = 0.5f * sinf( vradians );
+    int vlen;
+    fmultinc = 0.f;
+    if ( vconst ) {
+      vlen = acsamples;
+      fmult = ControlToFmult( cutoff, octavemult, ctl ? ctl[0] : 0.f );
+    }
+    else if ( acCtlStep <= 1 ) {
+      vlen = 1;
+      fmult = ControlToFmult( cutoff, octavemult, ctl[vpos] );
+    }
+    else {
+      vlen = acsamples - vpos < acCtlStep ? acsamples - vpos : acCtlStep;
+      fmultinc = ( ControlToFmult( cutoff, octavemult, ctl[vpos + vlen - 1] ) - fmult ) / vlen;
+    }
+    vpos += vlen;
+
+    while ( vlen-- )
+    {
+      fmult += fmultinc;
 
-    //---------------------------------------------------------------
-    // now do the state variable filter as normal, using fmult
-    input = *in++;
-    
-    // 2x oversamp: first pass
-    // in + inprev / 2, simple interp for getting the 'ghost prev sample'
-    lowpass = lowpass + fmult * bandpass;
-    highpass = ( (input + inputprev) * 0.5f ) - lowpass - damp * bandpass;
-    inputprev = input;
-    bandpass = bandpass + fmult * highpass;
-    lowpasstmp = lowpass;
-    
-    // second pass
-    lowpass = lowpass + fmult * bandpass;
-    highpass = input - lowpass - damp *bandpass;
-    bandpass = bandpass + fmult * highpass;
+      //---------------------------------------------------------------
+      // now do the state variable filter as normal, using fmult
+      input = *in++;
+      
+      // 2x oversamp: first pass
+      // in + inprev / 2, simple interp for getting the 'ghost prev sample'
+      lowpass = lowpass + fmult * bandpass;
+      highpass = ( (input + inputprev) * 0.5f ) - lowpass - damp * bandpass;
+      inputprev = input;
+      bandpass = bandpass + fmult * highpass;
+      lowpasstmp = lowpass;
+      bandpasstmp = bandpass;
+      highpasstmp = highpass;
+      
+      // second pass
+      lowpass = lowpass + fmult * bandpass;
+      highpass = input - lowpass - damp *bandpass;
+      bandpass = bandpass + fmult * highpass;
 
-    lowpasstmp = ( lowpass + lowpasstmp ) * 0.5f;
-    *out++ = lowpasstmp;
-    
-  } while (in < end);
+      lowpasstmp = ( lowpass + lowpasstmp ) * 0.5f;
+      bandpasstmp = ( bandpass + bandpasstmp ) * 0.5f;
+      highpasstmp = ( highpass + highpasstmp ) * 0.5f;
+      *out++ = wlp * lowpasstmp + wbp * bandpasstmp + whp * highpasstmp;
+    }
+  }
   
   state_inputprev = inputprev;
-  state_lowpass = lowpass;
-  state_bandpass = bandpass;
-       
-  return;
+  // silent input: the integrators decay towards the denormals
+  state_lowpass = FlushTiny( lowpass );
+  state_bandpass = FlushTiny( bandpass );
+  mLastFmult = fmult;
+}
+
+void VCFloat::UpdateWeights()
+{
+  switch ( mMode )
+  {
+    case FilterMode_LowPass:  mWeightLp = 1.f; mWeightBp = 0.f; mWeightHp = 0.f; break;
+    case FilterMode_BandPass: mWeightLp = 0.f; mWeightBp = 1.f; mWeightHp = 0.f; break;
+    case FilterMode_HighPass: mWeightLp = 0.f; mWeightBp = 0.f; mWeightHp = 1.f; break;
+    case FilterMode_Notch:    mWeightLp = 1.f; mWeightBp = 0.f; mWeightHp = 1.f; break;
+    case FilterMode_Peak:     mWeightLp = 1.f; mWeightBp = 0.f; mWeightHp = -1.f; break;
+    default:                  FilterMorph( mMorph, mWeightLp, mWeightBp, mWeightHp ); break;
+  }
 }